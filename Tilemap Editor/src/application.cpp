@@ -2,10 +2,14 @@
 
 #include <functional>
 #include <iostream>
+#include <sstream>
 #include <string>
 
+#include "benchmarks.h"
 #include "editor.h"
+#include "frame_scheduler.h"
 #include "input.h"
+#include "pixel_pool.h"
 #include "surface_window.h"
 #include "render_window.h"
 #include "imgui\\imgui.h"
@@ -13,10 +17,17 @@
 #include "imgui\\imgui_impl_sdlrenderer.h"
 
 namespace {
-	const int kDeltaTime = 1;
-	const int kGameSpeed = 1;
+	const int kFrameRateCap = 60;
+	const int kIdleTimeout = 500;
+	const int kImGuiSettleFrames = 3;
 
 	const int kScrollSpeed = 2;
+
+	const int kPixelPoolBudgetMegabytes = 64;
+	const size_t kMegabyte = 1024 * 1024;
+
+	const size_t kListedDuplicateGroups = 64;
+	const size_t kListedDuplicateTiles = 16;
 }
 
 Application::Application() {
@@ -34,11 +45,14 @@ Application::~Application() {
 
 void Application::eventLoop() {
 	RenderWindow render_window;
-	SurfaceWindow canvas_window(640, 480, 0);
-	SurfaceWindow palette_window(120, 480, SDL_WINDOW_SKIP_TASKBAR);
+	std::shared_ptr<PixelPool> pixel_pool(new PixelPool(kPixelPoolBudgetMegabytes * kMegabyte));
+	SurfaceWindow canvas_window(640, 480, 0, pixel_pool);
+	SurfaceWindow palette_window(120, 480, SDL_WINDOW_SKIP_TASKBAR, pixel_pool);
 
 	Input input;
 	SDL_Event event;
+	FrameScheduler frame_scheduler(kFrameRateCap, kIdleTimeout);
+	Benchmarks benchmarks;
 
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
@@ -50,186 +64,333 @@ void Application::eventLoop() {
 	current_color_ = 0;
 
 	editor_.reset(new Editor());
+	editor_->restoreSession(canvas_window, palette_window);
 
 	bool render_window_focused = false;
-	int last_update_time = SDL_GetTicks();
-	int frame_time_accumulator = 0;
+	int imgui_frames = kImGuiSettleFrames;
 	bool running = true;
 	while (running) {
-		const int start_frame_time = SDL_GetTicks();
-		const int frame_time = start_frame_time - last_update_time;
-		last_update_time = start_frame_time;
-		frame_time_accumulator += frame_time;
-
-		while (frame_time_accumulator >= kDeltaTime) {
-			input.beginNewFrame();
-			int previous_mouse_x, previous_mouse_y;
-			SDL_GetMouseState(&previous_mouse_x, &previous_mouse_y);
-
-			while (SDL_PollEvent(&event)) {
-				if(render_window_focused)
-					ImGui_ImplSDL2_ProcessEvent(&event);
-
-				switch (event.type) {
-				case SDL_KEYDOWN:
-					if (!event.key.repeat)
-						input.keyDownEvent(event);
-					break;
-				case SDL_KEYUP:
-					input.keyUpEvent(event);
-					break;
-				case SDL_MOUSEBUTTONDOWN:
-					input.mouseDownEvent(event);
+		editor_->collectSaves();
+		const bool saving = editor_->get_save_worker().isBusy();
+		if (saving) {
+			imgui_frames = kImGuiSettleFrames;
+		}
+		editor_->updateJournal();
+		frame_scheduler.waitForEvents(imgui_frames > 0 || input.isAnyMouseButtonHeld() || editor_->hasPendingJournal());
+
+		input.beginNewFrame();
+		int previous_mouse_x, previous_mouse_y;
+		SDL_GetMouseState(&previous_mouse_x, &previous_mouse_y);
+
+		while (SDL_PollEvent(&event)) {
+			imgui_frames = kImGuiSettleFrames;
+			if(render_window_focused)
+				ImGui_ImplSDL2_ProcessEvent(&event);
+
+			switch (event.type) {
+			case SDL_KEYDOWN:
+				if (!event.key.repeat)
+					input.keyDownEvent(event);
+				break;
+			case SDL_KEYUP:
+				input.keyUpEvent(event);
+				break;
+			case SDL_MOUSEBUTTONDOWN:
+				input.mouseDownEvent(event);
+				break;
+			case SDL_MOUSEBUTTONUP:
+				input.mouseUpEvent(event);
+				break;
+			case SDL_MOUSEWHEEL:
+				input.mouseWheelEvent(event);
+				break;
+			case SDL_WINDOWEVENT:
+				switch (event.window.event) {
+				case SDL_WINDOWEVENT_MOVED:
+					if (event.window.windowID == canvas_window.get_window_id()) {
+						palette_window.set_position(event.window.data1, event.window.data2);
+					}
 					break;
-				case SDL_MOUSEBUTTONUP:
-					input.mouseUpEvent(event);
+				case SDL_WINDOWEVENT_FOCUS_GAINED:
+					if (event.window.windowID == canvas_window.get_window_id()) {
+						palette_window.raise();
+					} else if (event.window.windowID == render_window.get_window_id()) {
+						render_window_focused = true;
+					}
 					break;
-				case SDL_MOUSEWHEEL:
-					input.mouseWheelEvent(event);
+				case SDL_WINDOWEVENT_EXPOSED:
+					if (event.window.windowID == canvas_window.get_window_id()) {
+						canvas_window.invalidate();
+					} else if (event.window.windowID == palette_window.get_window_id()) {
+						palette_window.invalidate();
+					}
 					break;
-				case SDL_WINDOWEVENT:
-					switch (event.window.event) {
-					case SDL_WINDOWEVENT_MOVED:
-						if (event.window.windowID == canvas_window.get_window_id()) {
-							palette_window.set_position(event.window.data1, event.window.data2);
-						}
-						break;
-					case SDL_WINDOWEVENT_FOCUS_GAINED:
-						if (event.window.windowID == canvas_window.get_window_id()) {
-							palette_window.raise();
-						} else if (event.window.windowID == render_window.get_window_id()) {
-							render_window_focused = true;
-						}
-						break;
-					case SDL_WINDOWEVENT_FOCUS_LOST:
-						if (event.window.windowID == render_window.get_window_id()) {
-							render_window_focused = false;
-						}
-						break;
-					default:
-						break;
+				case SDL_WINDOWEVENT_FOCUS_LOST:
+					if (event.window.windowID == render_window.get_window_id()) {
+						render_window_focused = false;
 					}
 					break;
 				default:
 					break;
 				}
+				break;
+			default:
+				break;
 			}
+		}
 
-			if (input.wasKeyPressed(SDLK_ESCAPE)) {
-				running = false;
-			}
+		if (input.wasKeyPressed(SDLK_ESCAPE)) {
+			running = false;
+		}
 
-			int canvas_mouse_x, canvas_mouse_y;
-			SDL_GetGlobalMouseState(&canvas_mouse_x, &canvas_mouse_y);
-			int canvas_window_x, canvas_window_y;
-			canvas_window.get_window_position(canvas_window_x, canvas_window_y);
-			canvas_mouse_x -= canvas_window_x;
-			canvas_mouse_y -= canvas_window_y;
+		int canvas_mouse_x, canvas_mouse_y;
+		SDL_GetGlobalMouseState(&canvas_mouse_x, &canvas_mouse_y);
+		int canvas_window_x, canvas_window_y;
+		canvas_window.get_window_position(canvas_window_x, canvas_window_y);
+		canvas_mouse_x -= canvas_window_x;
+		canvas_mouse_y -= canvas_window_y;
+
+		if (editor_) {
+			if (input.wasMouseButtonPressed(SDL_BUTTON_MIDDLE)) {
+				editor_->startMove(canvas_mouse_x, canvas_mouse_y);
+			} else if (input.isMouseButtonPressed(SDL_BUTTON_MIDDLE)) {
+				editor_->move(canvas_mouse_x, canvas_mouse_y, previous_mouse_x, previous_mouse_y);
+			} else if (input.wasMouseButtonReleased(SDL_BUTTON_MIDDLE)) {
+				editor_->stopMove();
+			}
 
-			if (editor_) {
-				if (input.wasMouseButtonPressed(SDL_BUTTON_MIDDLE)) {
-					editor_->startMove(canvas_mouse_x, canvas_mouse_y);
-				} else if (input.isMouseButtonPressed(SDL_BUTTON_MIDDLE)) {
-					editor_->move(canvas_mouse_x, canvas_mouse_y, previous_mouse_x, previous_mouse_y);
-				} else if (input.wasMouseButtonReleased(SDL_BUTTON_MIDDLE)) {
-					editor_->stopMove();
+			if (input.isMouseButtonPressed(SDL_BUTTON_LEFT)) {
+				editor_->putPixel(current_color_, canvas_mouse_x, canvas_mouse_y);
+			} else if (input.isMouseButtonPressed(SDL_BUTTON_RIGHT)) {
+				if (editor_->get_color_at_point(canvas_mouse_x, canvas_mouse_y) != std::nullopt) {
+					current_color_ = *editor_->get_color_at_point(canvas_mouse_x, canvas_mouse_y);
 				}
+			}
 
-				if (input.isMouseButtonPressed(SDL_BUTTON_LEFT)) {
-					editor_->putPixel(current_color_, canvas_mouse_x, canvas_mouse_y);
-				} else if (input.isMouseButtonPressed(SDL_BUTTON_RIGHT)) {
-					if (editor_->get_color_at_point(canvas_mouse_x, canvas_mouse_y) != std::nullopt) {
-						current_color_ = *editor_->get_color_at_point(canvas_mouse_x, canvas_mouse_y);
-					}
-				}
+			if (input.getWheelMovement() != 0) {
+				editor_->scale(input.getWheelMovement() * kScrollSpeed, canvas_mouse_x, canvas_mouse_y);
+			}
+		}
 
-				if (input.getWheelMovement() != 0) {
-					editor_->scale(input.getWheelMovement() * kScrollSpeed, canvas_mouse_x, canvas_mouse_y);
+		if (imgui_frames > 0) {
+			--imgui_frames;
+
+			ImGui_ImplSDLRenderer_NewFrame();
+			ImGui_ImplSDL2_NewFrame();
+			ImGui::NewFrame();
+
+			static int canvas_size = 1;
+			static bool sparse_canvas = false;
+			ImGui::Begin("ImGui");
+
+			ImGui::Checkbox("Sparse canvas", &sparse_canvas);
+			if (ImGui::Button("Create tile sheet")) {
+				editor_->createTileSheet(canvas_window, canvas_size, sparse_canvas);
+			}
+			ImGui::SameLine();
+			ImGui::PushItemWidth(100);
+			ImGui::DragInt("X/Y", &canvas_size, 0.1f, 1, 2147483647);
+
+			static int tile_map_size[2] = { 1, 1 };
+			static char buffer_tile_size[256] = {};
+			if (ImGui::Button("Create tile map")) {
+				std::string str = "content/images/";
+				str += buffer_tile_size;
+				editor_->createTileMap(canvas_window, palette_window, str, tile_map_size[0], tile_map_size[1]);
+			}
+			ImGui::SameLine();
+			ImGui::PushItemWidth(100);
+			ImGui::DragInt2("X/Y", tile_map_size, 0.1f, 1, 2147483647);
+			ImGui::SameLine();
+			ImGui::InputText("Tile sheet file path", buffer_tile_size, sizeof(buffer_tile_size));
+
+			if (ImGui::Button("Create palette")) {
+				editor_->createPalette(palette_window);
+			}
+			if (ImGui::Button("Extend X")) {
+				editor_->extendCanvasX();
+			}
+			if (ImGui::Button("Extend Y")) {
+				editor_->extendCanvasY();
+			}
+			if (ImGui::Button("Truncate X")) {
+				editor_->truncateCanvasX();
+			}
+			if (ImGui::Button("Truncate Y")) {
+				editor_->truncateCanvasY();
+			}
+
+			static float color_float[3] = { 0, 0, 0 };
+			if (ImGui::ColorPicker3("Color", color_float, 0)) {
+				current_color_ = ((int(color_float[2] * 255)) << 16) | ((int(color_float[1] * 255)) << 8) | int(color_float[0] * 255);
+			}
+
+			char buffer_save_file[256] = {};
+			if (ImGui::InputText("Save file", buffer_save_file, sizeof(buffer_save_file), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->saveCanvas("content/images/" + static_cast<std::string>(buffer_save_file));
+			}
+			static int distance_field_size = editor_->get_distance_field_size();
+			if (ImGui::DragInt("Collision SDF size (0 = off)", &distance_field_size, 0.1f, 0, 64)) {
+				editor_->set_distance_field_size(distance_field_size);
+			}
+			const SaveWorker& save_worker = editor_->get_save_worker();
+			if (saving) {
+				ImGui::ProgressBar(save_worker.get_progress());
+			}
+			if (save_worker.get_status() != SaveWorker::IDLE) {
+				ImGui::Text("%s (superseded: %d)", save_worker.get_message().c_str(), save_worker.get_superseded());
+			}
+			if (save_worker.get_collision_boxes() >= 0) {
+				ImGui::Text("Collision boxes: %d for %d solid cells", save_worker.get_collision_boxes(), save_worker.get_solid_cells());
+			}
+			if (save_worker.get_collision_polygons() >= 0) {
+				ImGui::Text("Collision outlines: %d polygons, %d points", save_worker.get_collision_polygons(), save_worker.get_collision_points());
+			}
+			char buffer_load_tile_sheet_as_canvas[256] = {};
+			if (ImGui::InputText("Load tile sheet as canvas", buffer_load_tile_sheet_as_canvas, sizeof(buffer_load_tile_sheet_as_canvas), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->loadTileSheetAsCanvas(canvas_window, "content/images/" + static_cast<std::string>(buffer_load_tile_sheet_as_canvas), false);
+			}
+			char buffer_load_tile_sheet_as_palette[256] = {};
+			if (ImGui::InputText("Load tile sheet as palette", buffer_load_tile_sheet_as_palette, sizeof(buffer_load_tile_sheet_as_palette), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->loadTileSheetAsPalette(palette_window, "content/images/" + static_cast<std::string>(buffer_load_tile_sheet_as_palette));
+			}
+			char buffer_load_tile_map[256] = {};
+			if (ImGui::InputText("Load tile map", buffer_load_tile_map, sizeof(buffer_load_tile_map), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->loadTileMap(canvas_window, palette_window, "content/images/" + static_cast<std::string>(buffer_load_tile_map), false);
+			}
+			char buffer_convert_tile_map[256] = {};
+			if (ImGui::InputText("Convert legacy tile map", buffer_convert_tile_map, sizeof(buffer_convert_tile_map), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->convertLegacyTileMap("content/images/" + static_cast<std::string>(buffer_convert_tile_map));
+			}
+			char buffer_export_trimmed_map[256] = {};
+			if (ImGui::InputText("Export trimmed map", buffer_export_trimmed_map, sizeof(buffer_export_trimmed_map), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->exportTrimmedMap(palette_window, "content/images/" + static_cast<std::string>(buffer_export_trimmed_map));
+			}
+			static char buffer_trimmed_atlas[256] = {};
+			ImGui::InputText("Trimmed atlas", buffer_trimmed_atlas, sizeof(buffer_trimmed_atlas));
+			char buffer_export_trimmed_maps[1024] = {};
+			if (ImGui::InputText("Export trimmed maps (space separated)", buffer_export_trimmed_maps, sizeof(buffer_export_trimmed_maps), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				std::istringstream map_names(buffer_export_trimmed_maps);
+				std::vector<std::string> map_paths;
+				std::string map_name;
+				while (map_names >> map_name) {
+					map_paths.push_back("content/images/" + map_name);
 				}
+				editor_->exportTrimmedMaps(palette_window, map_paths, "content/images/" + static_cast<std::string>(buffer_trimmed_atlas));
+			}
+			static int import_tile_size = 16;
+			ImGui::DragInt("Import tile size", &import_tile_size, 0.1f, 1, 1024);
+			char buffer_import_level_image[256] = {};
+			if (ImGui::InputText("Import level image", buffer_import_level_image, sizeof(buffer_import_level_image), ImGuiInputTextFlags_EnterReturnsTrue)) {
+				editor_->importLevelImage(canvas_window, palette_window, "content/images/" + static_cast<std::string>(buffer_import_level_image), import_tile_size);
 			}
 
-			frame_time_accumulator -= kDeltaTime;
-		}
+			static bool idle_when_inactive = true;
+			if (ImGui::Checkbox("Idle when inactive", &idle_when_inactive)) {
+				frame_scheduler.set_idle_enabled(idle_when_inactive);
+			}
+			static int frame_rate_cap = kFrameRateCap;
+			if (ImGui::DragInt("Frame rate cap", &frame_rate_cap, 1.0f, 0, 1000)) {
+				frame_scheduler.set_frame_rate_cap(frame_rate_cap);
+			}
 
-		ImGui_ImplSDLRenderer_NewFrame();
-		ImGui_ImplSDL2_NewFrame();
-		ImGui::NewFrame();
+			static int pixel_pool_budget = kPixelPoolBudgetMegabytes;
+			if (ImGui::DragInt("Pixel pool budget (MB)", &pixel_pool_budget, 1.0f, 0, 65536)) {
+				pixel_pool->set_budget(pixel_pool_budget * kMegabyte);
+			}
+			ImGui::Text("Pixels live: %.1f MB, peak: %.1f MB, pooled: %.1f MB",
+				pixel_pool->get_live_bytes() * 1.0f / kMegabyte,
+				pixel_pool->get_peak_bytes() * 1.0f / kMegabyte,
+				pixel_pool->get_pooled_bytes() * 1.0f / kMegabyte);
+
+			static int tile_cache_budget = int(editor_->get_tile_cache_budget() / kMegabyte);
+			if (ImGui::DragInt("Tile cache budget (MB)", &tile_cache_budget, 1.0f, 0, 65536)) {
+				editor_->set_tile_cache_budget(tile_cache_budget * kMegabyte);
+			}
+			if (const TileChunkCache* tile_chunk_cache = editor_->get_tile_chunk_cache()) {
+				ImGui::Text("Tile cache: %d chunks, %.1f MB, hits: %llu, misses: %llu",
+					(int)tile_chunk_cache->get_entries(),
+					tile_chunk_cache->get_bytes() * 1.0f / kMegabyte,
+					(unsigned long long)tile_chunk_cache->get_hits(),
+					(unsigned long long)tile_chunk_cache->get_misses());
+			}
 
-		static int canvas_size = 1;
-		ImGui::Begin("ImGui");
+			if (ImGui::CollapsingHeader("Duplicate tiles")) {
+				static int duplicate_distance = 4;
+				ImGui::DragInt("Near-duplicate distance (-1 = exact only)", &duplicate_distance, 0.1f, -1, TileDuplicates::kMaxDistance);
+				if (ImGui::Button("Find duplicates")) {
+					editor_->findDuplicateTiles(duplicate_distance);
+				}
+				const std::vector<TileDuplicates::Group>& duplicate_groups = editor_->get_duplicate_groups();
+				ImGui::SameLine();
+				ImGui::Text("%d groups", (int)duplicate_groups.size());
+				if (editor_->canMergeDuplicateTiles() && !duplicate_groups.empty()) {
+					ImGui::SameLine();
+					if (ImGui::Button("Merge all")) {
+						editor_->mergeAllDuplicateTiles();
+					}
+				}
+				for (size_t i = 0; i < duplicate_groups.size() && i < kListedDuplicateGroups; ++i) {
+					const TileDuplicates::Group& group = duplicate_groups[i];
+					std::string tiles;
+					for (size_t j = 0; j < group.tiles.size() && j < kListedDuplicateTiles; ++j) {
+						tiles += std::to_string(group.tiles[j]) + " ";
+					}
+					if (group.tiles.size() > kListedDuplicateTiles) {
+						tiles += "...";
+					}
+					ImGui::Text("%s %s", group.exact ? "Exact:" : "Similar:", tiles.c_str());
+					if (editor_->canMergeDuplicateTiles()) {
+						ImGui::SameLine();
+						ImGui::PushID((int)i);
+						const bool merge = ImGui::Button("Merge");
+						ImGui::PopID();
+						if (merge) {
+							editor_->mergeDuplicateTiles(i);
+							break;
+						}
+					}
+				}
+			}
 
-		if (ImGui::Button("Create tile sheet")) {
-			editor_->createTileSheet(canvas_window, canvas_size);
-		}
-		ImGui::SameLine();
-		ImGui::PushItemWidth(100);
-		ImGui::DragInt("X/Y", &canvas_size, 0.1f, 1, 2147483647);
-
-		static int tile_map_size[2] = { 1, 1 };
-		static char buffer_tile_size[256] = {};
-		if (ImGui::Button("Create tile map")) {
-			std::string str = "content/images/";
-			str += buffer_tile_size;
-			editor_->createTileMap(canvas_window, palette_window, str, tile_map_size[0], tile_map_size[1]);
-		}
-		ImGui::SameLine();
-		ImGui::PushItemWidth(100);
-		ImGui::DragInt2("X/Y", tile_map_size, 0.1f, 1, 2147483647);
-		ImGui::SameLine();
-		ImGui::InputText("Tile sheet file path", buffer_tile_size, sizeof(buffer_tile_size));
-
-		if (ImGui::Button("Create palette")) {
-			editor_->createPalette(palette_window);
-		}
-		if (ImGui::Button("Extend X")) {
-			editor_->extendCanvasX(canvas_window);
-		}
-		if (ImGui::Button("Extend Y")) {
-			editor_->extendCanvasY(canvas_window);
-		}
-		if (ImGui::Button("Truncate X")) {
-			editor_->truncateCanvasX(canvas_window);
-		}
-		if (ImGui::Button("Truncate Y")) {
-			editor_->truncateCanvasY(canvas_window);
-		}
+			if (ImGui::CollapsingHeader("Benchmarks")) {
+				if (ImGui::Button("Integer scaler")) {
+					benchmarks.runIntegerScaler();
+				}
+				ImGui::SameLine();
+				if (ImGui::Button("Grid overlay")) {
+					benchmarks.runGridOverlay();
+				}
+				ImGui::SameLine();
+				if (ImGui::Button("Collision profile")) {
+					benchmarks.runCollisionProfile();
+				}
+				for (size_t i = 0; i < benchmarks.get_results().size(); ++i) {
+					const Benchmarks::Result& result = benchmarks.get_results()[i];
+					ImGui::Text("%s: %.3f ms -> %.3f ms", result.name.c_str(), result.baseline_milliseconds, result.optimized_milliseconds);
+				}
+			}
 
-		static float color_float[3] = { 0, 0, 0 };
-		if (ImGui::ColorPicker3("Color", color_float, 0)) {
-			current_color_ = ((int(color_float[2] * 255)) << 16) | ((int(color_float[1] * 255)) << 8) | int(color_float[0] * 255);
-		}
+			ImGui::End();
 
-		char buffer_save_file[256] = {};
-		if (ImGui::InputText("Save file", buffer_save_file, sizeof(buffer_save_file), ImGuiInputTextFlags_EnterReturnsTrue)) {
-			editor_->saveCanvas(canvas_window, "content/images/" + static_cast<std::string>(buffer_save_file));
-		}
-		char buffer_load_tile_sheet_as_canvas[256] = {};
-		if (ImGui::InputText("Load tile sheet as canvas", buffer_load_tile_sheet_as_canvas, sizeof(buffer_load_tile_sheet_as_canvas), ImGuiInputTextFlags_EnterReturnsTrue)) {
-			editor_->loadTileSheetAsCanvas(canvas_window, "content/images/" + static_cast<std::string>(buffer_load_tile_sheet_as_canvas));
-		}
-		char buffer_load_tile_sheet_as_palette[256] = {};
-		if (ImGui::InputText("Load tile sheet as palette", buffer_load_tile_sheet_as_palette, sizeof(buffer_load_tile_sheet_as_palette), ImGuiInputTextFlags_EnterReturnsTrue)) {
-			editor_->loadTileSheetAsPalette(palette_window, "content/images/" + static_cast<std::string>(buffer_load_tile_sheet_as_palette));
-		}
-		char buffer_load_tile_map[256] = {};
-		if (ImGui::InputText("Load tile map", buffer_load_tile_map, sizeof(buffer_load_tile_map), ImGuiInputTextFlags_EnterReturnsTrue)) {
-			editor_->loadTileMap(canvas_window, "content/images/" + static_cast<std::string>(buffer_load_tile_map));
+			ImGui::Render();
+			render_window.clear();
+			ImGui_ImplSDLRenderer_RenderDrawData(ImGui::GetDrawData());
+			render_window.flip();
 		}
 
-		ImGui::End();
+		editor_->submitDamage(canvas_window, palette_window);
+		if (canvas_window.isDirty() || palette_window.isDirty()) {
+			canvas_window.clear();
+			palette_window.clear();
 
-		ImGui::Render();
-		render_window.clear();
-		ImGui_ImplSDLRenderer_RenderDrawData(ImGui::GetDrawData());
-		render_window.flip();
+			editor_->draw(canvas_window, palette_window);
+
+			palette_window.flip();
+			canvas_window.flip();
+		}
 
-		canvas_window.clear();
-		palette_window.clear();
-		
-		editor_->draw(canvas_window, palette_window);
-		
-		palette_window.flip();
-		canvas_window.flip();
+		frame_scheduler.limitFrameRate();
 
 	}
 }
\ No newline at end of file
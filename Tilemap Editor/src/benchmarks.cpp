@@ -0,0 +1,178 @@
+#include "benchmarks.h"
+
+#include <SDL.h>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+#include "chunked_surface.h"
+#include "collision_profile.h"
+#include "grid_overlay.h"
+#include "parallel.h"
+#include "pixel_pool.h"
+#include "pixel_scaler.h"
+
+namespace {
+	const int kIterations = 50;
+
+	const int kScalerSourceSize = 256;
+	const int kScalerFactor = 4;
+
+	const int kGridIterations = 5;
+	const int kGridWindowWidth = 1280;
+	const int kGridWindowHeight = 720;
+	const int kGridCellSize = 16;
+	const int kGridMapSizes[] = { 64, 256, 1024 };
+
+	const int kProfileIterations = 5;
+	const int kProfileSheetSize = 2048;
+	const int kProfileTileSize = 16;
+	const size_t kProfilePoolBudget = 32 * 1024 * 1024;
+
+	double millisecondsSince(Uint64 start_counter) {
+		return (SDL_GetPerformanceCounter() - start_counter) * 1000.0 / SDL_GetPerformanceFrequency();
+	}
+
+	void drawLine(SDL_Surface* surface, int x1, int y1, int x2, int y2) {
+		SDL_Rect rectangle = { x1, y1, 1, 1 };
+		if (x2 - x1 > y2 - y1) {
+			rectangle.w = x2 - x1;
+		} else {
+			rectangle.h = y2 - y1;
+		}
+		SDL_FillRect(surface, &rectangle, 0);
+	}
+
+	void computeProfilePerPixel(const ChunkedSurface& pixels, int tile_size, std::vector<int>& heights) {
+		heights.clear();
+		for (int y = 0; y < pixels.get_height(); y += tile_size) {
+			for (int x = 0; x < pixels.get_width(); x += tile_size) {
+				for (int x_world = 0; x_world < tile_size; ++x_world) {
+					for (int y_world = 0; y_world < tile_size; ++y_world) {
+						const Uint32 pixel = pixels.getPixel(x + x_world, y + y_world);
+
+						if ((pixel & 0x00ffffff) != 0) {
+							heights.push_back(tile_size - y_world);
+							break;
+						} else if (y_world == tile_size - 1) {
+							heights.push_back(0);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void drawGridPerCell(SDL_Surface* surface, float x_offset, int map_size) {
+		const int size = map_size * kGridCellSize;
+		for (int x = 0; x < size; x += kGridCellSize) {
+			for (int y = 0; y < size; y += kGridCellSize) {
+				const int screen_left = int(floor(x + x_offset));
+				drawLine(surface, screen_left, y, int(floor(x + kGridCellSize + x_offset)), 0);
+				drawLine(surface, screen_left, y, int(floor(x_offset)), y + kGridCellSize);
+			}
+		}
+	}
+}
+
+void Benchmarks::runIntegerScaler() {
+	SDL_Surface* source = SDL_CreateRGBSurfaceWithFormat(0, kScalerSourceSize, kScalerSourceSize, 32, SDL_PIXELFORMAT_BGRA32);
+	SDL_SetSurfaceBlendMode(source, SDL_BLENDMODE_NONE);
+	Uint32* pixels = (Uint32*)source->pixels_;
+	for (int i = 0; i < kScalerSourceSize * kScalerSourceSize; ++i) {
+		pixels[i] = (Uint32)rand() | 0xff000000;
+	}
+	const int destination_size = kScalerSourceSize * kScalerFactor;
+	SDL_Surface* destination = SDL_CreateRGBSurfaceWithFormat(0, destination_size, destination_size, 32, SDL_PIXELFORMAT_RGB888);
+
+	SDL_Rect source_rectangle = { 0, 0, kScalerSourceSize, kScalerSourceSize };
+	Uint64 start_counter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < kIterations; ++i) {
+		SDL_Rect destination_rectangle = { 0, 0, destination_size, destination_size };
+		SDL_BlitScaled(source, &source_rectangle, destination, &destination_rectangle);
+	}
+	const double baseline_milliseconds = millisecondsSince(start_counter) / kIterations;
+
+	PixelScaler pixel_scaler;
+	start_counter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < kIterations; ++i) {
+		pixel_scaler.scaleInteger(source, source_rectangle, kScalerFactor, kScalerFactor, destination, 0, 0);
+	}
+	const double optimized_milliseconds = millisecondsSince(start_counter) / kIterations;
+
+	SDL_FreeSurface(destination);
+	SDL_FreeSurface(source);
+
+	Result result;
+	result.name = std::string("Integer scaler x4 (") + pixel_scaler.get_name() + ") vs SDL_BlitScaled";
+	result.baseline_milliseconds = baseline_milliseconds;
+	result.optimized_milliseconds = optimized_milliseconds;
+	results_.push_back(result);
+}
+
+void Benchmarks::runGridOverlay() {
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, kGridWindowWidth, kGridWindowHeight, 32, SDL_PIXELFORMAT_RGB888);
+	const SDL_Rect bounds = { 0, 0, kGridWindowWidth, kGridWindowHeight };
+
+	for (size_t i = 0; i < sizeof(kGridMapSizes) / sizeof(kGridMapSizes[0]); ++i) {
+		const int map_size = kGridMapSizes[i];
+
+		Uint64 start_counter = SDL_GetPerformanceCounter();
+		for (int j = 0; j < kGridIterations; ++j) {
+			drawGridPerCell(surface, float(j & 1), map_size);
+		}
+		const double baseline_milliseconds = millisecondsSince(start_counter) / kGridIterations;
+
+		GridOverlay grid_overlay;
+		start_counter = SDL_GetPerformanceCounter();
+		for (int j = 0; j < kGridIterations; ++j) {
+			grid_overlay.update(float(j & 1), 0, 1, 1, map_size * kGridCellSize, map_size * kGridCellSize, kGridCellSize, kGridCellSize, bounds);
+			const std::vector<SDL_Rect>& rectangles = grid_overlay.get_rectangles();
+			SDL_FillRects(surface, rectangles.data(), (int)rectangles.size(), 0);
+		}
+		const double optimized_milliseconds = millisecondsSince(start_counter) / kGridIterations;
+
+		Result result;
+		result.name = "Grid overlay " + std::to_string(map_size) + "x" + std::to_string(map_size) + " tiles (rebuilt every frame)";
+		result.baseline_milliseconds = baseline_milliseconds;
+		result.optimized_milliseconds = optimized_milliseconds;
+		results_.push_back(result);
+	}
+
+	SDL_FreeSurface(surface);
+}
+
+void Benchmarks::runCollisionProfile() {
+	std::shared_ptr<PixelPool> pixel_pool(new PixelPool(kProfilePoolBudget));
+	ChunkedSurface pixels(pixel_pool, kProfileSheetSize, kProfileSheetSize, 0xff000000, false);
+	for (int x = 0; x < kProfileSheetSize; ++x) {
+		const int surface = rand() % (kProfileTileSize + 1);
+		for (int y = 0; y < kProfileSheetSize; ++y) {
+			if (y % kProfileTileSize >= surface) {
+				pixels.setPixel(x, y, 0xff000000 | (Uint32)rand());
+			}
+		}
+	}
+
+	std::vector<int> heights;
+	Uint64 start_counter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < kProfileIterations; ++i) {
+		computeProfilePerPixel(pixels, kProfileTileSize, heights);
+	}
+	const double baseline_milliseconds = millisecondsSince(start_counter) / kProfileIterations;
+
+	std::unique_ptr<CollisionProfile> collision_profile;
+	start_counter = SDL_GetPerformanceCounter();
+	for (int i = 0; i < kProfileIterations; ++i) {
+		collision_profile.reset(new CollisionProfile(pixels, kProfileTileSize));
+	}
+	const double optimized_milliseconds = millisecondsSince(start_counter) / kProfileIterations;
+
+	Result result;
+	result.name = "Collision profile " + std::to_string(kProfileSheetSize) + "x" + std::to_string(kProfileSheetSize) +
+		" (" + collision_profile->get_name() + ", " + std::to_string(get_worker_count()) + " threads" +
+		(collision_profile->get_heights() == heights ? "" : ", MISMATCH") + ") vs per-pixel loop";
+	result.baseline_milliseconds = baseline_milliseconds;
+	result.optimized_milliseconds = optimized_milliseconds;
+	results_.push_back(result);
+}
\ No newline at end of file
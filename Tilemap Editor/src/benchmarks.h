@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+struct Benchmarks {
+	struct Result {
+		std::string name;
+		double baseline_milliseconds;
+		double optimized_milliseconds;
+	};
+
+	void runIntegerScaler();
+	void runGridOverlay();
+	void runCollisionProfile();
+
+	const std::vector<Result>& get_results() const { return results_; }
+private:
+	std::vector<Result> results_;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "bmp_writer.h"
+
+namespace {
+	const Uint32 kFileHeaderSize = 14;
+	const Uint32 kInfoHeaderSize = 40;
+	const Uint16 kBitsPerPixel = 32;
+	const Uint32 kPixelsPerMeter = 2835;
+}
+
+BmpWriter::BmpWriter(const std::string& file_path, int width, int height) :
+	writer_(file_path),
+	width_(width) {
+	const Uint32 image_size = Uint32(width) * Uint32(height) * sizeof(Uint32);
+	writer_.write("BM", 2);
+	writer_.writeLE32(kFileHeaderSize + kInfoHeaderSize + image_size);
+	writer_.writeLE32(0);
+	writer_.writeLE32(kFileHeaderSize + kInfoHeaderSize);
+
+	writer_.writeLE32(kInfoHeaderSize);
+	writer_.writeLE32(Uint32(width));
+	writer_.writeLE32(Uint32(-height));
+	writer_.writeLE16(1);
+	writer_.writeLE16(kBitsPerPixel);
+	writer_.writeLE32(0);
+	writer_.writeLE32(image_size);
+	writer_.writeLE32(kPixelsPerMeter);
+	writer_.writeLE32(kPixelsPerMeter);
+	writer_.writeLE32(0);
+	writer_.writeLE32(0);
+}
+
+void BmpWriter::writeRow(const Uint32* pixels) {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	writer_.write(pixels, width_ * sizeof(Uint32));
+#else
+	for (int x = 0; x < width_; ++x) {
+		writer_.writeLE32(pixels[x]);
+	}
+#endif
+}
+
+bool BmpWriter::close() {
+	return writer_.close();
+}
\ No newline at end of file
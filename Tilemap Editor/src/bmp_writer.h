@@ -0,0 +1,18 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+
+#include "buffered_writer.h"
+
+struct BmpWriter {
+	BmpWriter(const std::string& file_path, int width, int height);
+
+	void writeRow(const Uint32* pixels);
+	bool close();
+
+	bool isOpen() const { return writer_.isOpen(); }
+private:
+	BufferedWriter writer_;
+	int width_;
+};
\ No newline at end of file
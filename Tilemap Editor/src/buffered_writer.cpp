@@ -0,0 +1,178 @@
+#include "buffered_writer.h"
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const size_t kMaxNumberLength = 16;
+	const char* const kTemporaryExtension = ".tmp";
+}
+
+BufferedWriter::BufferedWriter(const std::string& file_path) :
+	file_path_(file_path),
+	temporary_path_(file_path + kTemporaryExtension),
+#ifdef _WIN32
+	file_(INVALID_HANDLE_VALUE),
+#else
+	file_(-1),
+#endif
+	used_(0),
+	failed_(false) {
+	openFile();
+}
+
+BufferedWriter::~BufferedWriter() {
+	close();
+}
+
+void BufferedWriter::write(const void* data, size_t size) {
+	const char* bytes = (const char*)data;
+	while (size > 0) {
+		if (used_ == kBufferSize) {
+			flush();
+		}
+		const size_t length = size < kBufferSize - used_ ? size : kBufferSize - used_;
+		memcpy(buffer_ + used_, bytes, length);
+		used_ += length;
+		bytes += length;
+		size -= length;
+	}
+}
+
+void BufferedWriter::write(const char* text) {
+	write(text, strlen(text));
+}
+
+void BufferedWriter::write(char character) {
+	if (used_ == kBufferSize) {
+		flush();
+	}
+	buffer_[used_++] = character;
+}
+
+void BufferedWriter::writeNumber(int value) {
+	if (kBufferSize - used_ < kMaxNumberLength) {
+		flush();
+	}
+	used_ = std::to_chars(buffer_ + used_, buffer_ + kBufferSize, value).ptr - buffer_;
+}
+
+void BufferedWriter::writeLE16(Uint16 value) {
+	value = SDL_SwapLE16(value);
+	write(&value, sizeof(value));
+}
+
+void BufferedWriter::writeLE32(Uint32 value) {
+	value = SDL_SwapLE32(value);
+	write(&value, sizeof(value));
+}
+
+bool BufferedWriter::close() {
+	if (!isOpen())
+		return false;
+
+	flush();
+	const bool synced = !failed_ && syncFile();
+	closeFile();
+	if (!synced) {
+		std::remove(temporary_path_.c_str());
+		return false;
+	}
+	return replaceFile();
+}
+
+void BufferedWriter::flush() {
+	if (isOpen() && used_ > 0 && !writeFile(buffer_, used_)) {
+		failed_ = true;
+	}
+	used_ = 0;
+}
+
+bool BufferedWriter::isOpen() const {
+#ifdef _WIN32
+	return file_ != INVALID_HANDLE_VALUE;
+#else
+	return file_ >= 0;
+#endif
+}
+
+#ifdef _WIN32
+bool BufferedWriter::openFile() {
+	file_ = CreateFileA(temporary_path_.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	return file_ != INVALID_HANDLE_VALUE;
+}
+
+bool BufferedWriter::writeFile(const char* data, size_t size) {
+	DWORD written;
+	return WriteFile(file_, data, (DWORD)size, &written, nullptr) && written == size;
+}
+
+bool BufferedWriter::syncFile() {
+	return FlushFileBuffers(file_) != 0;
+}
+
+void BufferedWriter::closeFile() {
+	CloseHandle(file_);
+	file_ = INVALID_HANDLE_VALUE;
+}
+
+bool BufferedWriter::replaceFile() {
+	if (!MoveFileExA(temporary_path_.c_str(), file_path_.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+		std::remove(temporary_path_.c_str());
+		return false;
+	}
+	return true;
+}
+#else
+bool BufferedWriter::openFile() {
+	file_ = ::open(temporary_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	return file_ >= 0;
+}
+
+bool BufferedWriter::writeFile(const char* data, size_t size) {
+	while (size > 0) {
+		const ssize_t written = ::write(file_, data, size);
+		if (written <= 0)
+			return false;
+		data += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+bool BufferedWriter::syncFile() {
+	return fsync(file_) == 0;
+}
+
+void BufferedWriter::closeFile() {
+	::close(file_);
+	file_ = -1;
+}
+
+bool BufferedWriter::replaceFile() {
+	if (std::rename(temporary_path_.c_str(), file_path_.c_str()) != 0) {
+		std::remove(temporary_path_.c_str());
+		return false;
+	}
+
+	const size_t separator = file_path_.find_last_of('/');
+	const std::string directory = separator == std::string::npos ? "." : file_path_.substr(0, separator + 1);
+	const int directory_file = ::open(directory.c_str(), O_RDONLY);
+	if (directory_file >= 0) {
+		fsync(directory_file);
+		::close(directory_file);
+	}
+	return true;
+}
+#endif
\ No newline at end of file
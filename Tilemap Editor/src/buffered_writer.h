@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+
+struct BufferedWriter {
+	static constexpr size_t kBufferSize = 64 * 1024;
+
+	explicit BufferedWriter(const std::string& file_path);
+	~BufferedWriter();
+
+	BufferedWriter(const BufferedWriter&) = delete;
+	BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+	void write(const void* data, size_t size);
+	void write(const char* text);
+	void write(char character);
+	void writeNumber(int value);
+	void writeLE16(Uint16 value);
+	void writeLE32(Uint32 value);
+	bool close();
+
+	bool isOpen() const;
+private:
+	void flush();
+	bool openFile();
+	bool writeFile(const char* data, size_t size);
+	bool syncFile();
+	void closeFile();
+	bool replaceFile();
+
+	std::string file_path_;
+	std::string temporary_path_;
+#ifdef _WIN32
+	void* file_;
+#else
+	int file_;
+#endif
+	char buffer_[kBufferSize];
+	size_t used_;
+	bool failed_;
+};
\ No newline at end of file
@@ -2,31 +2,33 @@
 
 #include <memory>
 #include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "surface_window.h"
 #include "rectangle.h"
 
-Canvas::Canvas(SurfaceWindow& graphics, float start_offset_x, float start_offset_y, int width, int height) :
+namespace {
+	const Uint32 kFillPixel = 0xffffffff;
+	const float kScaleResolution = 100.0f;
+}
+
+Canvas::Canvas(SurfaceWindow& graphics, float start_offset_x, float start_offset_y, int width, int height, bool sparse) :
+	sprite_sheet_(graphics.get_pixel_pool(), width, height, kFillPixel, sparse),
+	mip_chain_(graphics.get_pixel_pool(), sprite_sheet_),
+	fully_damaged_(true),
 	x_offset_(start_offset_x), y_offset_(start_offset_y),
 	scale_x_(1), scale_y_(1),
-	moving_(false),
-	loaded_(false) {
-	sprite_sheet_ = graphics.createSurface(width, height);
-	
+	moving_(false) {
 }
 
 Canvas::Canvas(SurfaceWindow& graphics, const std::string& file_path, float start_offset_x, float start_offset_y) :
+	sprite_sheet_(graphics.get_pixel_pool(), graphics.loadImage(file_path, false)),
+	mip_chain_(graphics.get_pixel_pool(), sprite_sheet_),
+	fully_damaged_(true),
 	x_offset_(start_offset_x), y_offset_(start_offset_y),
 	scale_x_(1), scale_y_(1), 
-	moving_(false),
-	loaded_(true) {
-	sprite_sheet_ = graphics.loadImage(file_path, false);
-}
-
-Canvas::~Canvas() {
-	if(!loaded_)
-		SDL_FreeSurface(sprite_sheet_);
+	moving_(false) {
 }
 
 void Canvas::startMoving(int x, int y) {
@@ -34,11 +36,12 @@ void Canvas::startMoving(int x, int y) {
 }
 
 void Canvas::move(int x, int previous_x, int y, int previous_y) {
-	if (!moving_)
+	if (!moving_ || (x == previous_x && y == previous_y))
 		return;
 
 	x_offset_ -= ((previous_x-x) / scale_x_);
 	y_offset_ -= ((previous_y-y) / scale_y_);
+	invalidate();
 }
 
 void Canvas::stopMoving() {
@@ -51,30 +54,41 @@ void Canvas::scale(float scale, int x, int y) {
 
 	scale_x_ += scale;
 	scale_y_ += scale;
-	scale_x_ = std::max(scale_x_, 0.1f);
-	scale_y_ = std::max(scale_y_, 0.1f);
+	scale_x_ = std::max(float(round(scale_x_ * kScaleResolution) / kScaleResolution), 0.1f);
+	scale_y_ = std::max(float(round(scale_y_ * kScaleResolution) / kScaleResolution), 0.1f);
 
 	float mouse_x_after_zoom, mouse_y_after_zoom;
 	screenToWorld(x, y, mouse_x_after_zoom, mouse_y_after_zoom);
 
 	x_offset_ -= (mouse_x_before_zoom - mouse_x_after_zoom);
 	y_offset_ -= (mouse_y_before_zoom - mouse_y_after_zoom);
+	invalidate();
 }
 
-void Canvas::drawToTexture(int x, int y, Uint32 color) {
+std::optional<SDL_Point> Canvas::drawToTexture(int x, int y, Uint32 color) {
 	float world_x, world_y;
 	screenToWorld(x, y, world_x, world_y);
 	int new_world_x = int(world_x);
 	int new_world_y = int(world_y);
 
 	if (pointSpriteIntersection(new_world_x, new_world_y)) {
-		SDL_LockSurface(sprite_sheet_);
-		Uint8* pixel_array = (Uint8*)sprite_sheet_->pixels_;
-		pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 0] = (color >> 16) & 0xff;
-		pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 1] = (color >> 8) & 0xff;
-		pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 2] = color & 0xff;
-		SDL_UnlockSurface(sprite_sheet_);
+		const Uint32 pixel = sprite_sheet_.getPixel(new_world_x, new_world_y);
+		const Uint32 new_pixel = (pixel & 0xff000000) | ((color & 0xff) << 16) | (color & 0xff00) | ((color >> 16) & 0xff);
+		if (setPixel(new_world_x, new_world_y, new_pixel)) {
+			return SDL_Point{ new_world_x, new_world_y };
+		}
 	}
+	return std::nullopt;
+}
+
+bool Canvas::setPixel(int x, int y, Uint32 pixel) {
+	if (!pointSpriteIntersection(x, y) || sprite_sheet_.getPixel(x, y) == pixel)
+		return false;
+
+	sprite_sheet_.setPixel(x, y, pixel);
+	mip_chain_.invalidate(x, y, 1, 1);
+	damageWorldRectangle(x, y, 1, 1);
+	return true;
 }
 
 std::optional<Uint32> Canvas::getPixel(int x, int y) const {
@@ -84,68 +98,119 @@ std::optional<Uint32> Canvas::getPixel(int x, int y) const {
 	int new_world_y = int(world_y);
 
 	if (pointSpriteIntersection(new_world_x, new_world_y)) {
-		Uint8* pixel_array = (Uint8*)sprite_sheet_->pixels_;
-		Uint8 red = pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 2];
-		Uint8 green = pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 1];
-		Uint8 blue = pixel_array[new_world_y * sprite_sheet_->pitch + new_world_x * sprite_sheet_->format->BytesPerPixel + 0];
-		return std::optional<Uint32>(SDL_MapRGB(sprite_sheet_->format, blue, green, red));
+		const Uint32 pixel = sprite_sheet_.getPixel(new_world_x, new_world_y);
+		Uint8 red = (pixel >> 16) & 0xff;
+		Uint8 green = (pixel >> 8) & 0xff;
+		Uint8 blue = pixel & 0xff;
+		return std::optional<Uint32>((0xffu << 24) | (blue << 16) | (green << 8) | red);
 	}
 	return std::nullopt;
 }
 
-void Canvas::save(SurfaceWindow& graphics, const std::string& file_path) const {
-	graphics.saveSurface(sprite_sheet_, file_path);
+void Canvas::copyFrom(const Canvas& source, const SDL_Rect& source_rectangle, int x, int y) {
+	copyFrom(source.sprite_sheet_, source_rectangle, x, y);
+}
+
+void Canvas::copyFrom(const ChunkedSurface& source, const SDL_Rect& source_rectangle, int x, int y) {
+	sprite_sheet_.copyRegion(source, source_rectangle, x, y);
+	mip_chain_.invalidate(x, y, source_rectangle.w, source_rectangle.h);
+	damageWorldRectangle(x, y, source_rectangle.w, source_rectangle.h);
+}
+
+std::shared_ptr<const ChunkedSurface> Canvas::snapshot() const {
+	return sprite_sheet_.snapshot();
+}
+
+void Canvas::resize(int width, int height) {
+	sprite_sheet_.resize(width, height);
+	mip_chain_.reset();
+	invalidate();
 }
 
-void Canvas::changeSize(SurfaceWindow& graphics, int x, int y) {
-	sprite_sheet_ = graphics.changeSurfaceSize(sprite_sheet_, x, y);
+void Canvas::discardPixels() {
+	sprite_sheet_.discardChunks();
+	mip_chain_.reset();
+	invalidate();
 }
 
 int Canvas::get_width() const {
-	return sprite_sheet_->w;
+	return sprite_sheet_.get_width();
 }
 
 int Canvas::get_height() const {
-	return sprite_sheet_->h;
+	return sprite_sheet_.get_height();
 }
 
-SDL_Surface* Canvas::get_surface() const {
+const ChunkedSurface& Canvas::get_surface() const {
 	return sprite_sheet_;
 }
 
 void Canvas::draw(SurfaceWindow& graphics) const {
-	SDL_Rect destination_rectangle;
-	int screen_left, screen_top;
-	worldToScreen(0, 0, screen_left, screen_top);
-	destination_rectangle.x = screen_left;
-	destination_rectangle.y = screen_top;
-
-	int screen_right, screen_bottom;
-	worldToScreen(sprite_sheet_->w * 1.0f, sprite_sheet_->h * 1.0f, screen_right, screen_bottom);
-	destination_rectangle.w = screen_right - screen_left;
-	destination_rectangle.h = screen_bottom - screen_top;
-
-	graphics.blitSurface(sprite_sheet_, NULL, &destination_rectangle, false);
-}
+	SDL_Rect visible_rectangle;
+	if (!visibleWorldRectangle(graphics.get_clip_rectangle(), visible_rectangle))
+		return;
 
-void Canvas::drawGrid(SurfaceWindow& graphics, int width, int height) const {
-	for (int x = 0; x < get_width(); x += width) {
-		for (int y = 0; y < get_height(); y += height) {
+	const bool integer_scale = scale_x_ >= 1 && scale_y_ >= 1 && scale_x_ == floor(scale_x_) && scale_y_ == floor(scale_y_);
+	const int level = mip_chain_.levelForScale(std::min(scale_x_, scale_y_));
+
+	const int level_left = visible_rectangle.x >> level;
+	const int level_top = visible_rectangle.y >> level;
+	const int level_right = (visible_rectangle.x + visible_rectangle.w + (1 << level) - 1) >> level;
+	const int level_bottom = (visible_rectangle.y + visible_rectangle.h + (1 << level) - 1) >> level;
+
+	const int first_column = level_left / ChunkedSurface::kChunkSize;
+	const int last_column = (level_right - 1) / ChunkedSurface::kChunkSize;
+	const int first_row = level_top / ChunkedSurface::kChunkSize;
+	const int last_row = (level_bottom - 1) / ChunkedSurface::kChunkSize;
+	for (int row = first_row; row <= last_row; ++row) {
+		for (int column = first_column; column <= last_column; ++column) {
+			const int chunk_left = column * ChunkedSurface::kChunkSize;
+			const int chunk_top = row * ChunkedSurface::kChunkSize;
+			const int left = std::max(level_left, chunk_left);
+			const int top = std::max(level_top, chunk_top);
+			const int right = std::min(level_right, chunk_left + ChunkedSurface::kChunkSize);
+			const int bottom = std::min(level_bottom, chunk_top + ChunkedSurface::kChunkSize);
+
+			SDL_Rect source_rectangle;
+			source_rectangle.x = left - chunk_left;
+			source_rectangle.y = top - chunk_top;
+			source_rectangle.w = right - left;
+			source_rectangle.h = bottom - top;
+
+			SDL_Rect destination_rectangle;
 			int screen_left, screen_top;
-			worldToScreen(x * 1.0f, y * 1.0f, screen_left, screen_top);
-			int screen_right, screen_bottom;
-			worldToScreen(x*1.0f + width, 0, screen_right, screen_bottom);
+			worldToScreen(float(left << level), float(top << level), screen_left, screen_top);
+			destination_rectangle.x = screen_left;
+			destination_rectangle.y = screen_top;
 
-			graphics.drawLine(screen_left, screen_top, screen_right, screen_bottom, 0);
-			worldToScreen(0, y * 1.0f + height, screen_right, screen_bottom);
-			graphics.drawLine(screen_left, screen_top, screen_right, screen_bottom, 0);
+			int screen_right, screen_bottom;
+			worldToScreen(float(std::min(right << level, get_width())), float(std::min(bottom << level, get_height())), screen_right, screen_bottom);
+			destination_rectangle.w = screen_right - screen_left;
+			destination_rectangle.h = screen_bottom - screen_top;
+
+			SDL_Surface* chunk = mip_chain_.get_chunk(level, column, row);
+			if (chunk && integer_scale) {
+				graphics.blitSurfaceInteger(chunk, source_rectangle, screen_left, screen_top, int(scale_x_), int(scale_y_));
+			} else if (chunk) {
+				graphics.blitSurface(chunk, &source_rectangle, &destination_rectangle, false);
+			} else {
+				graphics.fillRect(destination_rectangle, sprite_sheet_.get_fill_pixel() & 0xffffff);
+			}
 		}
 	}
 }
 
+void Canvas::drawGrid(SurfaceWindow& graphics, int width, int height) const {
+	int window_width, window_height;
+	graphics.get_window_size(window_width, window_height);
+	const SDL_Rect bounds = { 0, 0, window_width, window_height };
+	grid_overlay_.update(x_offset_, y_offset_, scale_x_, scale_y_, get_width(), get_height(), width, height, bounds);
+	graphics.fillRects(grid_overlay_.get_rectangles(), 0);
+}
+
 void Canvas::worldToScreen(float world_x, float world_y, int& screen_x, int& screen_y) const {
-	screen_x = int((world_x + x_offset_) * scale_x_);
-	screen_y = int((world_y + y_offset_) * scale_y_);
+	screen_x = int(floor((world_x + x_offset_) * scale_x_));
+	screen_y = int(floor((world_y + y_offset_) * scale_y_));
 }
 
 void Canvas::screenToWorld(int screen_x, int screen_y, float& world_x, float& world_y) const {
@@ -154,10 +219,13 @@ void Canvas::screenToWorld(int screen_x, int screen_y, float& world_x, float& wo
 }
 
 void Canvas::snapToBounds(const Rectangle& bounds) {
+	const float old_x_offset = x_offset_;
+	const float old_y_offset = y_offset_;
+
 	int screen_left, screen_top;
 	worldToScreen(0, 0, screen_left, screen_top);
 	int screen_right, screen_bottom;
-	worldToScreen(sprite_sheet_->w * 1.0f, sprite_sheet_->h * 1.0f, screen_right, screen_bottom);
+	worldToScreen(get_width() * 1.0f, get_height() * 1.0f, screen_right, screen_bottom);
 
 	const int width = screen_right - screen_left;
 	const int difference_x = std::max(width - bounds.width() / 2, 0);
@@ -174,8 +242,64 @@ void Canvas::snapToBounds(const Rectangle& bounds) {
 	} else if (screen_bottom > bounds.bottom() + difference_y) {
 		y_offset_ = (bounds.bottom() + difference_y - height) / scale_y_ * 1.0f;
 	}
+
+	if (x_offset_ != old_x_offset || y_offset_ != old_y_offset) {
+		invalidate();
+	}
 }
 
 bool Canvas::pointSpriteIntersection(int x, int y) const {
-	return y > -1 && y < sprite_sheet_->h && x > -1 && x < sprite_sheet_->w;
+	return y > -1 && y < get_height() && x > -1 && x < get_width();
+}
+
+bool Canvas::visibleWorldRectangle(const SDL_Rect& screen_rectangle, SDL_Rect& world_rectangle) const {
+	float world_left, world_top;
+	screenToWorld(screen_rectangle.x, screen_rectangle.y, world_left, world_top);
+	float world_right, world_bottom;
+	screenToWorld(screen_rectangle.x + screen_rectangle.w, screen_rectangle.y + screen_rectangle.h, world_right, world_bottom);
+
+	world_rectangle.x = std::max(int(floor(world_left)), 0);
+	world_rectangle.y = std::max(int(floor(world_top)), 0);
+	world_rectangle.w = std::min(int(ceil(world_right)), get_width()) - world_rectangle.x;
+	world_rectangle.h = std::min(int(ceil(world_bottom)), get_height()) - world_rectangle.y;
+	return world_rectangle.w > 0 && world_rectangle.h > 0;
+}
+
+void Canvas::invalidate() {
+	fully_damaged_ = true;
+	damaged_rectangles_.clear();
+}
+
+void Canvas::invalidate(int x, int y, int width, int height) {
+	mip_chain_.invalidate(x, y, width, height);
+	damageWorldRectangle(x, y, width, height);
+}
+
+void Canvas::submitDamage(SurfaceWindow& graphics) {
+	if (fully_damaged_) {
+		graphics.invalidate();
+	} else {
+		for (size_t i = 0; i < damaged_rectangles_.size(); ++i) {
+			graphics.invalidate(damaged_rectangles_[i]);
+		}
+	}
+	damaged_rectangles_.clear();
+	fully_damaged_ = false;
+}
+
+void Canvas::damageWorldRectangle(int x, int y, int width, int height) {
+	if (fully_damaged_)
+		return;
+
+	int screen_left, screen_top;
+	worldToScreen(x * 1.0f, y * 1.0f, screen_left, screen_top);
+	int screen_right, screen_bottom;
+	worldToScreen((x + width) * 1.0f, (y + height) * 1.0f, screen_right, screen_bottom);
+
+	SDL_Rect rectangle;
+	rectangle.x = screen_left - 1;
+	rectangle.y = screen_top - 1;
+	rectangle.w = screen_right - screen_left + 2;
+	rectangle.h = screen_bottom - screen_top + 2;
+	damaged_rectangles_.push_back(rectangle);
 }
@@ -3,30 +3,40 @@
 #include <string>
 #include <SDL.h>
 #include <optional>
+#include <vector>
+
+#include "chunked_surface.h"
+#include "grid_overlay.h"
+#include "mip_chain.h"
 
 struct SurfaceWindow;
 struct Rectangle;
 
 struct Canvas {
-	Canvas(SurfaceWindow& graphics, float start_offset_x, float start_offset_y, int width, int height);
+	Canvas(SurfaceWindow& graphics, float start_offset_x, float start_offset_y, int width, int height, bool sparse);
 	Canvas(SurfaceWindow& graphics, const std::string& file_path, float start_offset_x, float start_offset_y);
-	~Canvas();
 
 	void startMoving(int x, int y);
 	void move(int x, int previous_x, int y, int previous_y);
 	void stopMoving();
 	void scale(float scale_x, int x, int y);
 
-	void drawToTexture(int x, int y, Uint32 color);
+	std::optional<SDL_Point> drawToTexture(int x, int y, Uint32 color);
+	bool setPixel(int x, int y, Uint32 pixel);
 	std::optional<Uint32> getPixel(int x, int y) const;
+	void copyFrom(const Canvas& source, const SDL_Rect& source_rectangle, int x, int y);
+	void copyFrom(const ChunkedSurface& source, const SDL_Rect& source_rectangle, int x, int y);
 
-	void save(SurfaceWindow& graphics, const std::string& file_path) const;
+	std::shared_ptr<const ChunkedSurface> snapshot() const;
 
-	void changeSize(SurfaceWindow& graphics, int x, int y);
+	void resize(int width, int height);
+	void discardPixels();
 
 	int get_width() const;
 	int get_height() const;
-	SDL_Surface* get_surface() const;
+	float get_scale_x() const { return scale_x_; }
+	float get_scale_y() const { return scale_y_; }
+	const ChunkedSurface& get_surface() const;
 
 	void draw(SurfaceWindow& graphics) const;
 	void drawGrid(SurfaceWindow& graphics, int width, int height) const;
@@ -36,12 +46,22 @@ struct Canvas {
 
 	void snapToBounds(const Rectangle& bounds);
 	bool pointSpriteIntersection(int x, int y) const;
+	bool visibleWorldRectangle(const SDL_Rect& screen_rectangle, SDL_Rect& world_rectangle) const;
+
+	void invalidate();
+	void invalidate(int x, int y, int width, int height);
+	void submitDamage(SurfaceWindow& graphics);
 private:
-	SDL_Surface* sprite_sheet_;
+	void damageWorldRectangle(int x, int y, int width, int height);
+
+	ChunkedSurface sprite_sheet_;
+	mutable MipChain mip_chain_;
+	mutable GridOverlay grid_overlay_;
+	std::vector<SDL_Rect> damaged_rectangles_;
+	bool fully_damaged_;
 
 	float x_offset_, y_offset_;
 	float scale_x_, scale_y_;
 
 	bool moving_;
-	bool loaded_;
 };
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "chunked_surface.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pixel_pool.h"
+
+ChunkedSurface::ChunkedSurface(std::shared_ptr<PixelPool> pixel_pool, int width, int height, Uint32 fill_pixel, bool sparse) :
+	pixel_pool_(pixel_pool),
+	fill_row_(kChunkSize, fill_pixel),
+	width_(0), height_(0),
+	columns_(0), rows_(0),
+	capacity_columns_(0), capacity_rows_(0),
+	fill_pixel_(fill_pixel),
+	sparse_(sparse) {
+	resize(width, height);
+}
+
+ChunkedSurface::ChunkedSurface(std::shared_ptr<PixelPool> pixel_pool, SDL_Surface* surface) :
+	pixel_pool_(pixel_pool),
+	fill_row_(kChunkSize, 0xffffffff),
+	width_(0), height_(0),
+	columns_(0), rows_(0),
+	capacity_columns_(0), capacity_rows_(0),
+	fill_pixel_(0xffffffff),
+	sparse_(false) {
+	SDL_Surface* converted_surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_BGRA32, 0);
+	resize(converted_surface->w, converted_surface->h);
+
+	for (int y = 0; y < height_; ++y) {
+		const Uint32* source_row = (const Uint32*)((const Uint8*)converted_surface->pixels_ + y * converted_surface->pitch);
+		for (int x = 0; x < width_;) {
+			int length;
+			Uint32* destination = pixelSpan(x, y, length);
+			length = std::min(length, width_ - x);
+			memcpy(destination, source_row + x, length * sizeof(Uint32));
+			x += length;
+		}
+	}
+	SDL_FreeSurface(converted_surface);
+}
+
+void ChunkedSurface::resize(int width, int height) {
+	const int columns = (width + kChunkSize - 1) / kChunkSize;
+	const int rows = (height + kChunkSize - 1) / kChunkSize;
+
+	if (columns > capacity_columns_ || rows > capacity_rows_) {
+		reserve(columns > capacity_columns_ ? std::max(columns, capacity_columns_ * 2) : capacity_columns_,
+			rows > capacity_rows_ ? std::max(rows, capacity_rows_ * 2) : capacity_rows_);
+	}
+
+	const int old_width = width_;
+	const int old_height = height_;
+	width_ = width;
+	height_ = height;
+	columns_ = columns;
+	rows_ = rows;
+
+	if (width > old_width) {
+		fillRegion(old_width, 0, width - old_width, std::min(old_height, height));
+	}
+	if (height > old_height) {
+		fillRegion(0, old_height, width, height - old_height);
+	}
+
+	if (!sparse_) {
+		for (int row = 0; row < rows_; ++row) {
+			for (int column = 0; column < columns_; ++column) {
+				std::shared_ptr<SDL_Surface>& chunk = chunks_[row * capacity_columns_ + column];
+				if (!chunk)
+					chunk = createChunk(nullptr);
+			}
+		}
+	}
+
+	if (capacity_columns_ * capacity_rows_ > kCompactionSlack * std::max(columns_ * rows_, 1)) {
+		compact();
+	}
+}
+
+void ChunkedSurface::compact() {
+	for (int row = 0; row < capacity_rows_; ++row) {
+		for (int column = 0; column < capacity_columns_; ++column) {
+			if (row >= rows_ || column >= columns_) {
+				chunks_[row * capacity_columns_ + column].reset();
+			}
+		}
+	}
+	reserve(columns_, rows_);
+}
+
+void ChunkedSurface::discardChunks() {
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		chunks_[i].reset();
+	}
+	sparse_ = true;
+}
+
+std::shared_ptr<const ChunkedSurface> ChunkedSurface::snapshot() const {
+	std::shared_ptr<ChunkedSurface> snapshot(new ChunkedSurface(pixel_pool_, 0, 0, fill_pixel_, true));
+	snapshot->chunks_ = chunks_;
+	snapshot->width_ = width_;
+	snapshot->height_ = height_;
+	snapshot->columns_ = columns_;
+	snapshot->rows_ = rows_;
+	snapshot->capacity_columns_ = capacity_columns_;
+	snapshot->capacity_rows_ = capacity_rows_;
+	snapshot->sparse_ = sparse_;
+	return snapshot;
+}
+
+void ChunkedSurface::reserve(int capacity_columns, int capacity_rows) {
+	std::vector<std::shared_ptr<SDL_Surface>> chunks(capacity_columns * capacity_rows);
+	for (int row = 0; row < std::min(capacity_rows_, capacity_rows); ++row) {
+		for (int column = 0; column < std::min(capacity_columns_, capacity_columns); ++column) {
+			chunks[row * capacity_columns + column].swap(chunks_[row * capacity_columns_ + column]);
+		}
+	}
+	chunks_.swap(chunks);
+	capacity_columns_ = capacity_columns;
+	capacity_rows_ = capacity_rows;
+}
+
+Uint32 ChunkedSurface::getPixel(int x, int y) const {
+	int length;
+	return *pixelSpan(x, y, length);
+}
+
+void ChunkedSurface::setPixel(int x, int y, Uint32 pixel) {
+	int length;
+	*pixelSpan(x, y, length) = pixel;
+}
+
+void ChunkedSurface::copyRegion(const ChunkedSurface& source, const SDL_Rect& source_rectangle, int x, int y) {
+	const int left = std::max(source_rectangle.x, std::max(0, source_rectangle.x - x));
+	const int top = std::max(source_rectangle.y, std::max(0, source_rectangle.y - y));
+	const int right = std::min(std::min(source_rectangle.x + source_rectangle.w, source.width_), source_rectangle.x + width_ - x);
+	const int bottom = std::min(std::min(source_rectangle.y + source_rectangle.h, source.height_), source_rectangle.y + height_ - y);
+
+	for (int source_y = top; source_y < bottom; ++source_y) {
+		const int destination_y = y + source_y - source_rectangle.y;
+		for (int source_x = left; source_x < right;) {
+			const int destination_x = x + source_x - source_rectangle.x;
+			int source_length, destination_length;
+			const Uint32* source_pixels = source.pixelSpan(source_x, source_y, source_length);
+			Uint32* destination_pixels = pixelSpan(destination_x, destination_y, destination_length);
+			const int length = std::min(std::min(source_length, destination_length), right - source_x);
+			memcpy(destination_pixels, source_pixels, length * sizeof(Uint32));
+			source_x += length;
+		}
+	}
+}
+
+const Uint32* ChunkedSurface::pixelSpan(int x, int y, int& length) const {
+	const SDL_Surface* chunk = get_chunk(x / kChunkSize, y / kChunkSize);
+	length = kChunkSize - x % kChunkSize;
+	if (!chunk)
+		return fill_row_.data() + x % kChunkSize;
+	return (const Uint32*)((const Uint8*)chunk->pixels_ + (y % kChunkSize) * chunk->pitch) + x % kChunkSize;
+}
+
+Uint32* ChunkedSurface::pixelSpan(int x, int y, int& length) {
+	SDL_Surface* chunk = writableChunk(chunks_[(y / kChunkSize) * capacity_columns_ + x / kChunkSize]);
+	length = kChunkSize - x % kChunkSize;
+	return (Uint32*)((Uint8*)chunk->pixels_ + (y % kChunkSize) * chunk->pitch) + x % kChunkSize;
+}
+
+void ChunkedSurface::readRow(int x, int y, int length, Uint32* destination) const {
+	for (const int right = x + length; x < right;) {
+		int span_length;
+		const Uint32* source = pixelSpan(x, y, span_length);
+		span_length = std::min(span_length, right - x);
+		memcpy(destination, source, span_length * sizeof(Uint32));
+		destination += span_length;
+		x += span_length;
+	}
+}
+
+SDL_Surface* ChunkedSurface::flatten() const {
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width_, height_, 32, SDL_PIXELFORMAT_BGRA32);
+	for (int y = 0; y < height_; ++y) {
+		readRow(0, y, width_, (Uint32*)((Uint8*)surface->pixels_ + y * surface->pitch));
+	}
+	return surface;
+}
+
+std::shared_ptr<SDL_Surface> ChunkedSurface::createChunk(const SDL_Surface* source) const {
+	SDL_Surface* chunk = pixel_pool_->createSurface(kChunkSize, kChunkSize);
+	Uint32* pixels = (Uint32*)chunk->pixels_;
+	if (source) {
+		memcpy(pixels, source->pixels_, kChunkSize * kChunkSize * sizeof(Uint32));
+	} else {
+		std::fill(pixels, pixels + kChunkSize * kChunkSize, fill_pixel_);
+	}
+	SDL_SetSurfaceBlendMode(chunk, SDL_BLENDMODE_NONE);
+
+	std::shared_ptr<PixelPool> pixel_pool = pixel_pool_;
+	return std::shared_ptr<SDL_Surface>(chunk, [pixel_pool](SDL_Surface* surface) { pixel_pool->freeSurface(surface); });
+}
+
+SDL_Surface* ChunkedSurface::writableChunk(std::shared_ptr<SDL_Surface>& chunk) const {
+	if (!chunk) {
+		chunk = createChunk(nullptr);
+	} else if (chunk.use_count() > 1) {
+		chunk = createChunk(chunk.get());
+	}
+	return chunk.get();
+}
+
+void ChunkedSurface::fillRegion(int x, int y, int width, int height) {
+	if (width <= 0 || height <= 0)
+		return;
+
+	for (int chunk_row = y / kChunkSize; chunk_row <= (y + height - 1) / kChunkSize; ++chunk_row) {
+		for (int chunk_column = x / kChunkSize; chunk_column <= (x + width - 1) / kChunkSize; ++chunk_column) {
+			std::shared_ptr<SDL_Surface>& shared_chunk = chunks_[chunk_row * capacity_columns_ + chunk_column];
+			if (!shared_chunk)
+				continue;
+			SDL_Surface* chunk = writableChunk(shared_chunk);
+
+			SDL_Rect rectangle;
+			rectangle.x = std::max(x - chunk_column * kChunkSize, 0);
+			rectangle.y = std::max(y - chunk_row * kChunkSize, 0);
+			rectangle.w = std::min(x + width - chunk_column * kChunkSize, kChunkSize) - rectangle.x;
+			rectangle.h = std::min(y + height - chunk_row * kChunkSize, kChunkSize) - rectangle.y;
+			SDL_FillRect(chunk, &rectangle, fill_pixel_);
+		}
+	}
+}
\ No newline at end of file
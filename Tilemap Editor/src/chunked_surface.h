@@ -0,0 +1,58 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+struct PixelPool;
+
+struct ChunkedSurface {
+	static constexpr int kChunkSize = 64;
+	static constexpr int kCompactionSlack = 4;
+
+	ChunkedSurface(std::shared_ptr<PixelPool> pixel_pool, int width, int height, Uint32 fill_pixel, bool sparse);
+	ChunkedSurface(std::shared_ptr<PixelPool> pixel_pool, SDL_Surface* surface);
+
+	ChunkedSurface(const ChunkedSurface&) = delete;
+	ChunkedSurface& operator=(const ChunkedSurface&) = delete;
+
+	void resize(int width, int height);
+	void compact();
+	void discardChunks();
+	std::shared_ptr<const ChunkedSurface> snapshot() const;
+
+	Uint32 getPixel(int x, int y) const;
+	void setPixel(int x, int y, Uint32 pixel);
+	void copyRegion(const ChunkedSurface& source, const SDL_Rect& source_rectangle, int x, int y);
+	void readRow(int x, int y, int length, Uint32* destination) const;
+
+	const Uint32* pixelSpan(int x, int y, int& length) const;
+	Uint32* pixelSpan(int x, int y, int& length);
+
+	SDL_Surface* flatten() const;
+
+	bool isSparse() const { return sparse_; }
+	Uint32 get_fill_pixel() const { return fill_pixel_; }
+
+	int get_width() const { return width_; }
+	int get_height() const { return height_; }
+	int get_columns() const { return columns_; }
+	int get_rows() const { return rows_; }
+	int get_capacity_columns() const { return capacity_columns_; }
+	int get_capacity_rows() const { return capacity_rows_; }
+	SDL_Surface* get_chunk(int column, int row) const { return chunks_[row * capacity_columns_ + column].get(); }
+private:
+	void reserve(int capacity_columns, int capacity_rows);
+	std::shared_ptr<SDL_Surface> createChunk(const SDL_Surface* source) const;
+	SDL_Surface* writableChunk(std::shared_ptr<SDL_Surface>& chunk) const;
+	void fillRegion(int x, int y, int width, int height);
+
+	std::shared_ptr<PixelPool> pixel_pool_;
+	std::vector<std::shared_ptr<SDL_Surface>> chunks_;
+	std::vector<Uint32> fill_row_;
+	int width_, height_;
+	int columns_, rows_;
+	int capacity_columns_, capacity_rows_;
+	Uint32 fill_pixel_;
+	bool sparse_;
+};
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "collision_boxes.h"
+
+#include <algorithm>
+
+#include "collision_profile.h"
+#include "tile_grid.h"
+
+namespace {
+	void appendLE32(std::vector<Uint8>& data, Uint32 value) {
+		value = SDL_SwapLE32(value);
+		const Uint8* bytes = (const Uint8*)&value;
+		data.insert(data.end(), bytes, bytes + sizeof(value));
+	}
+}
+
+CollisionBoxes::CollisionBoxes(const TileGrid& tile_grid, const std::vector<bool>& solid_tiles) :
+	solid_cells_(0) {
+	const int columns = tile_grid.get_columns();
+	const int rows = tile_grid.get_rows();
+	std::vector<Uint8> open(size_t(columns) * rows, 0);
+	for (int row = 0; row < rows; ++row) {
+		for (int column = 0; column < columns; ++column) {
+			const int tile_index = tile_grid.get(column, row);
+			if (tile_index >= 0 && tile_index < (int)solid_tiles.size() && solid_tiles[tile_index]) {
+				open[size_t(row) * columns + column] = 1;
+				++solid_cells_;
+			}
+		}
+	}
+
+	for (int row = 0; row < rows; ++row) {
+		Uint8* cells = open.data() + size_t(row) * columns;
+		for (int column = 0; column < columns; ++column) {
+			if (!cells[column])
+				continue;
+
+			int width = 1;
+			while (column + width < columns && cells[column + width]) {
+				++width;
+			}
+
+			int height = 1;
+			for (; row + height < rows; ++height) {
+				const Uint8* below = cells + size_t(height) * columns + column;
+				int x = 0;
+				while (x < width && below[x]) {
+					++x;
+				}
+				if (x < width)
+					break;
+			}
+
+			for (int y = 0; y < height; ++y) {
+				std::fill(cells + size_t(y) * columns + column, cells + size_t(y) * columns + column + width, 0);
+			}
+			const SDL_Rect box = { column, row, width, height };
+			boxes_.push_back(box);
+			column += width - 1;
+		}
+	}
+}
+
+std::vector<bool> CollisionBoxes::solidTiles(const CollisionProfile& collision_profile) {
+	const int tile_size = collision_profile.get_tile_size();
+	std::vector<bool> solid_tiles(collision_profile.get_tile_count(), true);
+	for (int tile_index = 0; tile_index < collision_profile.get_tile_count(); ++tile_index) {
+		for (int column = 0; column < tile_size && solid_tiles[tile_index]; ++column) {
+			solid_tiles[tile_index] = collision_profile.get_height(tile_index, column) == tile_size;
+		}
+	}
+	return solid_tiles;
+}
+
+std::vector<Uint8> CollisionBoxes::serialize() const {
+	std::vector<Uint8> data;
+	data.reserve(sizeof(Uint32) * (1 + boxes_.size() * 4));
+	appendLE32(data, Uint32(boxes_.size()));
+	for (size_t i = 0; i < boxes_.size(); ++i) {
+		appendLE32(data, Uint32(boxes_[i].x));
+		appendLE32(data, Uint32(boxes_[i].y));
+		appendLE32(data, Uint32(boxes_[i].w));
+		appendLE32(data, Uint32(boxes_[i].h));
+	}
+	return data;
+}
\ No newline at end of file
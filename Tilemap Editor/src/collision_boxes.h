@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+struct CollisionProfile;
+struct TileGrid;
+
+struct CollisionBoxes {
+	static const Uint32 kSectionTag = SDL_FOURCC('B', 'O', 'X', 'S');
+
+	CollisionBoxes(const TileGrid& tile_grid, const std::vector<bool>& solid_tiles);
+
+	static std::vector<bool> solidTiles(const CollisionProfile& collision_profile);
+
+	std::vector<Uint8> serialize() const;
+
+	const std::vector<SDL_Rect>& get_boxes() const { return boxes_; }
+	int get_solid_cells() const { return solid_cells_; }
+private:
+	std::vector<SDL_Rect> boxes_;
+	int solid_cells_;
+};
\ No newline at end of file
@@ -0,0 +1,149 @@
+#include "collision_masks.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "buffered_writer.h"
+#include "chunked_surface.h"
+#include "parallel.h"
+
+namespace {
+	const char kMagic[4] = { 'T', 'C', 'O', 'L' };
+	const float kInfinity = 1e20f;
+	const float kDistanceRange = 127.0f;
+
+	Uint8 extractBits(const std::vector<Uint64>& words, int offset, int count) {
+		const size_t word = offset / SolidityMasker::kWordBits;
+		const int shift = offset % SolidityMasker::kWordBits;
+		if (word >= words.size())
+			return 0;
+
+		Uint64 bits = words[word] >> shift;
+		if (shift > SolidityMasker::kWordBits - count && word + 1 < words.size()) {
+			bits |= words[word + 1] << (SolidityMasker::kWordBits - shift);
+		}
+		return Uint8(bits & ((1u << count) - 1));
+	}
+
+	void transformLine(float* values, int count, int stride, std::vector<float>& line, std::vector<int>& hull, std::vector<float>& bounds) {
+		for (int i = 0; i < count; ++i) {
+			line[i] = values[i * stride];
+		}
+
+		int k = 0;
+		hull[0] = 0;
+		bounds[0] = -kInfinity;
+		bounds[1] = kInfinity;
+		for (int q = 1; q < count; ++q) {
+			float s;
+			while (true) {
+				const int p = hull[k];
+				s = ((line[q] + float(q * q)) - (line[p] + float(p * p))) / float(2 * q - 2 * p);
+				if (s > bounds[k] || k == 0)
+					break;
+				--k;
+			}
+			++k;
+			hull[k] = q;
+			bounds[k] = s;
+			bounds[k + 1] = kInfinity;
+		}
+
+		k = 0;
+		for (int q = 0; q < count; ++q) {
+			while (bounds[k + 1] < float(q)) {
+				++k;
+			}
+			const float offset = float(q - hull[k]);
+			values[q * stride] = offset * offset + line[hull[k]];
+		}
+	}
+
+	void transform(std::vector<float>& values, int size, std::vector<float>& line, std::vector<int>& hull, std::vector<float>& bounds) {
+		for (int x = 0; x < size; ++x) {
+			transformLine(values.data() + x, size, size, line, hull, bounds);
+		}
+		for (int y = 0; y < size; ++y) {
+			transformLine(values.data() + y * size, size, 1, line, hull, bounds);
+		}
+	}
+}
+
+CollisionMasks::CollisionMasks(const ChunkedSurface& pixels, int tile_size, int distance_field_size) :
+	tile_size_(tile_size),
+	tile_columns_(pixels.get_width() / tile_size),
+	tile_rows_(pixels.get_height() / tile_size),
+	row_bytes_((tile_size + 7) / 8),
+	distance_field_size_(std::min(distance_field_size, tile_size)),
+	masks_(size_t(tile_columns_) * tile_rows_ * tile_size * row_bytes_, 0),
+	distance_fields_(size_t(tile_columns_) * tile_rows_ * distance_field_size_ * distance_field_size_, 0) {
+	parallelFor(tile_rows_, [this, &pixels](int tile_row) { computeTileRow(pixels, tile_row); });
+}
+
+bool CollisionMasks::save(const std::string& file_path) const {
+	BufferedWriter writer(file_path);
+	if (!writer.isOpen())
+		return false;
+
+	writer.write(kMagic, sizeof(kMagic));
+	writer.writeLE16(kVersion);
+	writer.writeLE16(Uint16(distance_field_size_));
+	writer.writeLE32(Uint32(tile_size_));
+	writer.writeLE32(Uint32(tile_columns_));
+	writer.writeLE32(Uint32(tile_rows_));
+	writer.writeLE32(Uint32(row_bytes_));
+	writer.write(masks_.data(), masks_.size());
+	writer.write(distance_fields_.data(), distance_fields_.size());
+	return writer.close();
+}
+
+void CollisionMasks::computeTileRow(const ChunkedSurface& pixels, int tile_row) {
+	const int top = tile_row * tile_size_;
+	const int bottom = top + tile_size_;
+	std::vector<Uint64> words;
+	for (int y = top; y < bottom; ++y) {
+		solidity_masker_.maskRow(pixels, y, words);
+		for (int tile_column = 0; tile_column < tile_columns_; ++tile_column) {
+			const int tile_index = tile_row * tile_columns_ + tile_column;
+			Uint8* row = masks_.data() + (size_t(tile_index) * tile_size_ + y - top) * row_bytes_;
+			for (int byte = 0; byte < row_bytes_; ++byte) {
+				row[byte] = extractBits(words, tile_column * tile_size_ + byte * 8, std::min(8, tile_size_ - byte * 8));
+			}
+		}
+	}
+
+	if (distance_field_size_ > 0) {
+		const int pixel_count = tile_size_ * tile_size_;
+		std::vector<float> to_solid(pixel_count), to_empty(pixel_count), line(tile_size_), bounds(tile_size_ + 1);
+		std::vector<int> hull(tile_size_);
+		for (int tile_column = 0; tile_column < tile_columns_; ++tile_column) {
+			computeDistanceField(tile_row * tile_columns_ + tile_column, to_solid, to_empty, line, hull, bounds);
+		}
+	}
+}
+
+void CollisionMasks::computeDistanceField(int tile_index, std::vector<float>& to_solid, std::vector<float>& to_empty, std::vector<float>& line,
+	std::vector<int>& hull, std::vector<float>& bounds) {
+	for (int y = 0; y < tile_size_; ++y) {
+		for (int x = 0; x < tile_size_; ++x) {
+			const bool solid = isSolid(tile_index, x, y);
+			to_solid[y * tile_size_ + x] = solid ? 0.0f : kInfinity;
+			to_empty[y * tile_size_ + x] = solid ? kInfinity : 0.0f;
+		}
+	}
+	transform(to_solid, tile_size_, line, hull, bounds);
+	transform(to_empty, tile_size_, line, hull, bounds);
+
+	const float scale = kDistanceRange / tile_size_;
+	Sint8* distance_field = distance_fields_.data() + size_t(tile_index) * distance_field_size_ * distance_field_size_;
+	for (int sample_y = 0; sample_y < distance_field_size_; ++sample_y) {
+		const int y = (2 * sample_y + 1) * tile_size_ / (2 * distance_field_size_);
+		for (int sample_x = 0; sample_x < distance_field_size_; ++sample_x) {
+			const int x = (2 * sample_x + 1) * tile_size_ / (2 * distance_field_size_);
+			const float distance = isSolid(tile_index, x, y) ?
+				0.5f - std::sqrt(to_empty[y * tile_size_ + x]) :
+				std::sqrt(to_solid[y * tile_size_ + x]) - 0.5f;
+			distance_field[sample_y * distance_field_size_ + sample_x] = Sint8(std::max(-kDistanceRange, std::min(kDistanceRange, std::round(distance * scale))));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+#include "solidity_masker.h"
+
+struct ChunkedSurface;
+
+struct CollisionMasks {
+	static const Uint16 kVersion = 1;
+
+	CollisionMasks(const ChunkedSurface& pixels, int tile_size, int distance_field_size);
+
+	bool save(const std::string& file_path) const;
+
+	bool isSolid(int tile_index, int x, int y) const {
+		return ((masks_[(size_t(tile_index) * tile_size_ + y) * row_bytes_ + x / 8] >> (x % 8)) & 1) != 0;
+	}
+	Sint8 get_distance(int tile_index, int x, int y) const {
+		return distance_fields_[(size_t(tile_index) * distance_field_size_ + y) * distance_field_size_ + x];
+	}
+
+	int get_tile_count() const { return tile_columns_ * tile_rows_; }
+	int get_tile_size() const { return tile_size_; }
+	int get_row_bytes() const { return row_bytes_; }
+	int get_distance_field_size() const { return distance_field_size_; }
+private:
+	void computeTileRow(const ChunkedSurface& pixels, int tile_row);
+	void computeDistanceField(int tile_index, std::vector<float>& to_solid, std::vector<float>& to_empty, std::vector<float>& line,
+		std::vector<int>& hull, std::vector<float>& bounds);
+
+	SolidityMasker solidity_masker_;
+	int tile_size_;
+	int tile_columns_, tile_rows_;
+	int row_bytes_;
+	int distance_field_size_;
+	std::vector<Uint8> masks_;
+	std::vector<Sint8> distance_fields_;
+};
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "collision_outlines.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "collision_masks.h"
+#include "parallel.h"
+#include "tile_grid.h"
+
+namespace {
+	const int kCorners = 4;
+	const int kCornerX[kCorners] = { 0, 1, 1, 0 };
+	const int kCornerY[kCorners] = { 0, 0, 1, 1 };
+
+	struct TraceScratch {
+		std::vector<int> next;
+		std::vector<Uint8> entered;
+	};
+	thread_local TraceScratch trace_scratch;
+
+	Uint64 pointKey(const SDL_Point& point) {
+		return (Uint64(Uint32(point.x)) << 32) | Uint32(point.y);
+	}
+
+	SDL_Point edgeMidpoint(int x, int y, int from, int to) {
+		const SDL_Point point = { 2 * x + kCornerX[from] + kCornerX[to] + 1, 2 * y + kCornerY[from] + kCornerY[to] + 1 };
+		return point;
+	}
+
+	Sint64 cross(const SDL_Point& origin, const SDL_Point& a, const SDL_Point& b) {
+		return Sint64(a.x - origin.x) * (b.y - origin.y) - Sint64(a.y - origin.y) * (b.x - origin.x);
+	}
+
+	Sint64 squaredLength(const SDL_Point& a, const SDL_Point& b) {
+		return Sint64(b.x - a.x) * (b.x - a.x) + Sint64(b.y - a.y) * (b.y - a.y);
+	}
+
+	void appendLE32(std::vector<Uint8>& data, Uint32 value) {
+		value = SDL_SwapLE32(value);
+		const Uint8* bytes = (const Uint8*)&value;
+		data.insert(data.end(), bytes, bytes + sizeof(value));
+	}
+
+	void appendFloat(std::vector<Uint8>& data, float value) {
+		Uint32 bits;
+		memcpy(&bits, &value, sizeof(bits));
+		appendLE32(data, bits);
+	}
+}
+
+CollisionOutlines::CollisionOutlines(const CollisionMasks& masks, const TileGrid& tile_grid, float tolerance) :
+	width_(tile_grid.get_columns() * masks.get_tile_size()),
+	height_(tile_grid.get_rows() * masks.get_tile_size()) {
+	const int chunk_columns = (width_ + 1 + kChunkSize - 1) / kChunkSize;
+	const int chunk_rows = (height_ + 1 + kChunkSize - 1) / kChunkSize;
+	std::vector<Chunk> chunks(size_t(chunk_columns) * chunk_rows);
+	parallelFor((int)chunks.size(), [&](int index) {
+		const int left = (index % chunk_columns) * kChunkSize - 1;
+		const int top = (index / chunk_columns) * kChunkSize - 1;
+		traceChunk(masks, tile_grid, left, top, std::min(left + kChunkSize, width_), std::min(top + kChunkSize, height_), chunks[index]);
+	});
+
+	stitch(chunks);
+
+	const int doubled_tolerance = int(tolerance * 2.0f + 0.5f);
+	if (doubled_tolerance > 0) {
+		parallelFor((int)polygons_.size(), [this, doubled_tolerance](int index) { simplify(polygons_[index], doubled_tolerance); });
+	}
+	polygons_.erase(std::remove_if(polygons_.begin(), polygons_.end(),
+		[](const std::vector<SDL_Point>& polygon) { return polygon.size() < 3; }), polygons_.end());
+}
+
+std::vector<Uint8> CollisionOutlines::serialize() const {
+	std::vector<Uint8> data;
+	data.reserve(sizeof(Uint32) * (1 + polygons_.size() + get_point_count() * 2));
+	appendLE32(data, Uint32(polygons_.size()));
+	for (size_t i = 0; i < polygons_.size(); ++i) {
+		appendLE32(data, Uint32(polygons_[i].size()));
+		for (size_t j = 0; j < polygons_[i].size(); ++j) {
+			appendFloat(data, polygons_[i][j].x * 0.5f);
+			appendFloat(data, polygons_[i][j].y * 0.5f);
+		}
+	}
+	return data;
+}
+
+size_t CollisionOutlines::get_point_count() const {
+	size_t point_count = 0;
+	for (size_t i = 0; i < polygons_.size(); ++i) {
+		point_count += polygons_[i].size();
+	}
+	return point_count;
+}
+
+void CollisionOutlines::traceChunk(const CollisionMasks& masks, const TileGrid& tile_grid, int left, int top, int right, int bottom, Chunk& chunk) const {
+	const int tile_size = masks.get_tile_size();
+	const int samples_width = right - left + 1;
+	const int samples_height = bottom - top + 1;
+	std::vector<Uint8> samples(size_t(samples_width) * samples_height, 0);
+	const int first_x = std::max(left, 0);
+	const int last_x = std::min(right, width_ - 1);
+	for (int y = std::max(top, 0); y <= std::min(bottom, height_ - 1); ++y) {
+		Uint8* sample_row = samples.data() + size_t(y - top) * samples_width;
+		for (int x = first_x; x <= last_x;) {
+			const int tile_column = x / tile_size;
+			const int tile_end = std::min((tile_column + 1) * tile_size - 1, last_x);
+			const int tile_index = tile_grid.get(tile_column, y / tile_size);
+			if (tile_index >= 0 && tile_index < masks.get_tile_count()) {
+				for (int tile_x = x; tile_x <= tile_end; ++tile_x) {
+					sample_row[tile_x - left] = masks.isSolid(tile_index, tile_x - tile_column * tile_size, y % tile_size);
+				}
+			}
+			x = tile_end + 1;
+		}
+	}
+
+	const int stride = 2 * samples_width + 1;
+	const size_t points = size_t(stride) * (2 * samples_height + 1);
+	if (trace_scratch.next.size() < points) {
+		trace_scratch.next.assign(points, -1);
+		trace_scratch.entered.assign(points, 0);
+	}
+	std::vector<int>& next = trace_scratch.next;
+	std::vector<Uint8>& entered = trace_scratch.entered;
+
+	std::vector<int> starts;
+	for (int y = 0; y < samples_height - 1; ++y) {
+		const Uint8* upper = samples.data() + size_t(y) * samples_width;
+		const Uint8* lower = upper + samples_width;
+		for (int x = 0; x < samples_width - 1; ++x) {
+			const bool solid[kCorners] = { upper[x] != 0, upper[x + 1] != 0, lower[x + 1] != 0, lower[x] != 0 };
+			if (solid[0] == solid[1] && solid[1] == solid[2] && solid[2] == solid[3])
+				continue;
+
+			for (int corner = 0; corner < kCorners; ++corner) {
+				const int previous = (corner + kCorners - 1) % kCorners;
+				if (!solid[corner] || solid[previous])
+					continue;
+
+				int last = corner;
+				while (solid[(last + 1) % kCorners]) {
+					last = (last + 1) % kCorners;
+				}
+				const SDL_Point start = edgeMidpoint(x, y, previous, corner);
+				const SDL_Point end = edgeMidpoint(x, y, last, (last + 1) % kCorners);
+				const int start_index = start.y * stride + start.x;
+				const int end_index = end.y * stride + end.x;
+				next[start_index] = end_index;
+				entered[end_index] = 1;
+				starts.push_back(start_index);
+			}
+		}
+	}
+
+	const SDL_Point origin = { 2 * left, 2 * top };
+	const auto toPoint = [stride, origin](int index) {
+		const SDL_Point point = { origin.x + index % stride, origin.y + index / stride };
+		return point;
+	};
+	for (size_t i = 0; i < starts.size(); ++i) {
+		int index = starts[i];
+		if (next[index] < 0 || entered[index])
+			continue;
+
+		std::vector<SDL_Point> chain(1, toPoint(index));
+		while (next[index] >= 0) {
+			const int following = next[index];
+			next[index] = -1;
+			entered[following] = 0;
+			chain.push_back(toPoint(following));
+			index = following;
+		}
+		chunk.open.push_back(chain);
+	}
+
+	for (size_t i = 0; i < starts.size(); ++i) {
+		const int start = starts[i];
+		if (next[start] < 0)
+			continue;
+
+		std::vector<SDL_Point> polygon;
+		int index = start;
+		do {
+			polygon.push_back(toPoint(index));
+			const int following = next[index];
+			next[index] = -1;
+			entered[following] = 0;
+			index = following;
+		} while (index != start);
+		chunk.closed.push_back(polygon);
+	}
+}
+
+void CollisionOutlines::stitch(std::vector<Chunk>& chunks) {
+	std::vector<std::vector<SDL_Point>*> chains;
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		for (size_t j = 0; j < chunks[i].closed.size(); ++j) {
+			polygons_.push_back(std::vector<SDL_Point>());
+			polygons_.back().swap(chunks[i].closed[j]);
+		}
+		for (size_t j = 0; j < chunks[i].open.size(); ++j) {
+			chains.push_back(&chunks[i].open[j]);
+		}
+	}
+
+	std::unordered_map<Uint64, size_t> chain_starts;
+	for (size_t i = 0; i < chains.size(); ++i) {
+		chain_starts[pointKey(chains[i]->front())] = i;
+	}
+
+	std::vector<bool> used(chains.size(), false);
+	for (size_t i = 0; i < chains.size(); ++i) {
+		if (used[i])
+			continue;
+
+		std::vector<SDL_Point> polygon(*chains[i]);
+		used[i] = true;
+		const Uint64 start_key = pointKey(polygon.front());
+		while (pointKey(polygon.back()) != start_key) {
+			std::unordered_map<Uint64, size_t>::const_iterator link = chain_starts.find(pointKey(polygon.back()));
+			if (link == chain_starts.end() || used[link->second])
+				break;
+			used[link->second] = true;
+			polygon.insert(polygon.end(), chains[link->second]->begin() + 1, chains[link->second]->end());
+		}
+		if (pointKey(polygon.back()) == start_key) {
+			polygon.pop_back();
+		}
+		polygons_.push_back(std::vector<SDL_Point>());
+		polygons_.back().swap(polygon);
+	}
+}
+
+void CollisionOutlines::simplify(std::vector<SDL_Point>& polygon, int tolerance) {
+	const size_t count = polygon.size();
+	if (count <= 3)
+		return;
+
+	size_t farthest = 0;
+	Sint64 farthest_distance = -1;
+	for (size_t i = 1; i < count; ++i) {
+		const Sint64 distance = squaredLength(polygon[0], polygon[i]);
+		if (distance > farthest_distance) {
+			farthest_distance = distance;
+			farthest = i;
+		}
+	}
+
+	std::vector<bool> keep(count, false);
+	keep[0] = true;
+	keep[farthest] = true;
+	std::vector<std::pair<size_t, size_t>> spans;
+	spans.push_back(std::make_pair(size_t(0), farthest));
+	spans.push_back(std::make_pair(farthest, count));
+	while (!spans.empty()) {
+		const size_t first = spans.back().first;
+		const size_t last = spans.back().second;
+		spans.pop_back();
+		if (last - first < 2)
+			continue;
+
+		const SDL_Point& a = polygon[first];
+		const SDL_Point& b = polygon[last % count];
+		const Sint64 length = squaredLength(a, b);
+		size_t split = first;
+		double split_distance = 0.0;
+		for (size_t i = first + 1; i < last; ++i) {
+			const double distance = length > 0 ?
+				double(cross(a, b, polygon[i])) * double(cross(a, b, polygon[i])) / double(length) :
+				double(squaredLength(a, polygon[i]));
+			if (distance > split_distance) {
+				split_distance = distance;
+				split = i;
+			}
+		}
+		if (split_distance > double(tolerance) * tolerance) {
+			keep[split] = true;
+			spans.push_back(std::make_pair(first, split));
+			spans.push_back(std::make_pair(split, last));
+		}
+	}
+
+	size_t kept = 0;
+	for (size_t i = 0; i < count; ++i) {
+		if (keep[i]) {
+			polygon[kept++] = polygon[i];
+		}
+	}
+	polygon.resize(kept);
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+struct CollisionMasks;
+struct TileGrid;
+
+struct CollisionOutlines {
+	static const Uint32 kSectionTag = SDL_FOURCC('P', 'O', 'L', 'Y');
+	static constexpr int kChunkSize = 256;
+
+	CollisionOutlines(const CollisionMasks& masks, const TileGrid& tile_grid, float tolerance);
+
+	std::vector<Uint8> serialize() const;
+
+	const std::vector<std::vector<SDL_Point>>& get_polygons() const { return polygons_; }
+	size_t get_point_count() const;
+private:
+	struct Chunk {
+		std::vector<std::vector<SDL_Point>> closed;
+		std::vector<std::vector<SDL_Point>> open;
+	};
+
+	void traceChunk(const CollisionMasks& masks, const TileGrid& tile_grid, int left, int top, int right, int bottom, Chunk& chunk) const;
+	void stitch(std::vector<Chunk>& chunks);
+	static void simplify(std::vector<SDL_Point>& polygon, int tolerance);
+
+	int width_, height_;
+	std::vector<std::vector<SDL_Point>> polygons_;
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include "collision_profile.h"
+
+#include <algorithm>
+
+#include "buffered_writer.h"
+#include "chunked_surface.h"
+#include "parallel.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+	const int kMaskBits = SolidityMasker::kWordBits;
+
+	int lowestBit(Uint64 bits) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return (int)index;
+#elif defined(_MSC_VER)
+		unsigned long index;
+		if (_BitScanForward(&index, (unsigned long)bits))
+			return (int)index;
+		_BitScanForward(&index, (unsigned long)(bits >> 32));
+		return (int)index + 32;
+#else
+		return __builtin_ctzll(bits);
+#endif
+	}
+}
+
+CollisionProfile::CollisionProfile(const ChunkedSurface& pixels, int tile_size) :
+	tile_size_(tile_size),
+	tile_columns_(pixels.get_width() / tile_size),
+	tile_rows_(pixels.get_height() / tile_size),
+	heights_(size_t(tile_columns_) * tile_rows_ * tile_size, 0) {
+	parallelFor(tile_rows_, [this, &pixels](int tile_row) { computeTileRow(pixels, tile_row); });
+}
+
+bool CollisionProfile::save(const std::string& file_path) const {
+	BufferedWriter writer(file_path);
+	if (!writer.isOpen())
+		return false;
+	writer.writeNumber(tile_size_);
+
+	for (int tile_index = 0; tile_index < get_tile_count(); ++tile_index) {
+		writer.write('\n');
+		writer.writeNumber(tile_index);
+		writer.write(": ");
+		for (int column = 0; column < tile_size_; ++column) {
+			writer.writeNumber(get_height(tile_index, column));
+			writer.write(' ');
+		}
+	}
+	return writer.close();
+}
+
+void CollisionProfile::computeTileRow(const ChunkedSurface& pixels, int tile_row) {
+	const int width = tile_columns_ * tile_size_;
+	const int top = tile_row * tile_size_;
+	const int bottom = top + tile_size_;
+	int* heights = heights_.data() + size_t(tile_row) * tile_columns_ * tile_size_;
+
+	std::vector<Uint64> pending((width + kMaskBits - 1) / kMaskBits, ~Uint64(0));
+	if (width % kMaskBits != 0) {
+		pending.back() = (Uint64(1) << (width % kMaskBits)) - 1;
+	}
+	int pending_words = (int)pending.size();
+
+	for (int y = top; y < bottom && pending_words > 0; ++y) {
+		for (int x = 0; x < width;) {
+			int length;
+			const Uint32* span = pixels.pixelSpan(x, y, length);
+			length = std::min(std::min(length, width - x), kMaskBits - x % kMaskBits);
+
+			Uint64& pending_word = pending[x / kMaskBits];
+			Uint64 found = pending_word != 0 ? (solidity_masker_.mask(span, length) << (x % kMaskBits)) & pending_word : 0;
+			if (found != 0) {
+				pending_word &= ~found;
+				if (pending_word == 0) {
+					--pending_words;
+				}
+				for (; found != 0; found &= found - 1) {
+					heights[x / kMaskBits * kMaskBits + lowestBit(found)] = tile_size_ - (y - top);
+				}
+			}
+			x += length;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+#include <vector>
+
+#include "solidity_masker.h"
+
+struct ChunkedSurface;
+
+struct CollisionProfile {
+	CollisionProfile(const ChunkedSurface& pixels, int tile_size);
+
+	bool save(const std::string& file_path) const;
+
+	int get_height(int tile_index, int column) const { return heights_[size_t(tile_index) * tile_size_ + column]; }
+	int get_tile_count() const { return tile_columns_ * tile_rows_; }
+	int get_tile_size() const { return tile_size_; }
+	const std::vector<int>& get_heights() const { return heights_; }
+	const char* get_name() const { return solidity_masker_.get_name(); }
+private:
+	void computeTileRow(const ChunkedSurface& pixels, int tile_row);
+
+	SolidityMasker solidity_masker_;
+	int tile_size_;
+	int tile_columns_, tile_rows_;
+	std::vector<int> heights_;
+};
\ No newline at end of file
@@ -1,10 +1,16 @@
 #include "editor.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 
 #include "surface_window.h"
+#include "buffered_writer.h"
 #include "canvas.h"
+#include "map_file.h"
 #include "sprite.h"
+#include "tile_importer.h"
+#include "tile_trimmer.h"
 
 namespace {
 	const Rectangle kPaletteBounds(0, 0, 120, 480);
@@ -14,12 +20,33 @@ namespace {
 	const int kPaletteStartScale = 5;
 
 	const float kScaleAmount = 0.1f;
+
+	const size_t kTileCacheBudget = 64 * 1024 * 1024;
+
+	const char* const kImportedSheetSuffix = "_tiles";
+	const char* const kAtlasSuffix = "_atlas";
+	const char* const kTrimmedMapSuffix = "_trimmed";
+
+	const char* const kSessionPath = "content/session.txt";
+	const char* const kJournalExtension = ".journal";
+	const char* const kJournalArchiveExtension = ".journal.old";
+	const Uint32 kJournalSyncInterval = 1000;
+	const size_t kJournalCompactionRecords = 1 << 18;
 }
 
 Editor::Editor() :
 	editor_mode_(NONE),
 	canvas_tile_size_(1),
-	choosed_tile_row_(0), choosed_tile_col_(0) {
+	choosed_tile_row_(0), choosed_tile_col_(0),
+	tile_cache_budget_(kTileCacheBudget),
+	distance_field_size_(0),
+	palette_invalidated_(false),
+	journal_synced_ticks_(0) {
+}
+
+Editor::~Editor() {
+	journal_.close();
+	std::remove(kSessionPath);
 }
 
 void Editor::startMove(int x, int y) {
@@ -74,33 +101,27 @@ void Editor::putPixel(Uint32 color, int x, int y) {
 	if (canvas_) {
 		if (kCanvasBounds.pointIntersection(x, y)) {
 			if (editor_mode_ == TILE_SHEET) {
-				canvas_->drawToTexture(x, y, color);
+				if (std::optional<SDL_Point> point = canvas_->drawToTexture(x, y, color)) {
+					journal_.append(Journal::PIXEL, point->x, point->y, canvas_->get_surface().getPixel(point->x, point->y));
+				}
 			} else if (editor_mode_ == TILE_MAP) {
 				float x_world, y_world;
 				canvas_->screenToWorld(x, y, x_world, y_world);
 				if (palette_ && canvas_->pointSpriteIntersection((int)x_world, (int)y_world)) {
-					SDL_Surface* palette_surface = palette_->get_surface();
-					SDL_Rect source_rectangle;
-					source_rectangle.x = (int)choosed_tile_row_;
-					source_rectangle.y = (int)choosed_tile_col_;
-					source_rectangle.w = canvas_tile_size_;
-					source_rectangle.h = canvas_tile_size_;
-
-					SDL_Surface* canvas_surface = canvas_->get_surface();
 					x_world = floor(x_world);
 					x_world -= float(fmod(x_world, canvas_tile_size_));
 					y_world = floor(y_world);
 					y_world -= float(fmod(y_world, canvas_tile_size_));
-					SDL_Rect destination_rectangle;
-					destination_rectangle.x = (int)x_world;
-					destination_rectangle.y = (int)y_world;
-					destination_rectangle.w = canvas_tile_size_;
-					destination_rectangle.h = canvas_tile_size_;
 
 					const int tile_index = ((((int)choosed_tile_col_ * (palette_->get_width() / canvas_tile_size_)) + (int)choosed_tile_row_) / canvas_tile_size_);
-					tile_grid_[(int)y_world/canvas_tile_size_][(int)x_world/canvas_tile_size_] = tile_index;
-
-					SDL_BlitSurface(palette_surface, &source_rectangle, canvas_surface, &destination_rectangle);
+					const int tile_column = (int)x_world / canvas_tile_size_;
+					const int tile_row = (int)y_world / canvas_tile_size_;
+					if (tile_grid_.get(tile_column, tile_row) != tile_index) {
+						tile_grid_.set(tile_column, tile_row, tile_index);
+						journal_.append(Journal::TILE, tile_column, tile_row, Uint32(tile_index));
+						tile_map_renderer_->invalidateTile(tile_column, tile_row);
+						canvas_->invalidate((int)x_world, (int)y_world, canvas_tile_size_, canvas_tile_size_);
+					}
 				}
 			}
 		}
@@ -119,6 +140,7 @@ void Editor::putPixel(Uint32 color, int x, int y) {
 					choosed_tile_row_ -= float(fmod(choosed_tile_row_, canvas_tile_size_));
 					choosed_tile_col_ = floor(choosed_tile_col_);
 					choosed_tile_col_ -= float(fmod(choosed_tile_col_, canvas_tile_size_));
+					palette_invalidated_ = true;
 				}
 			}
 		}
@@ -134,137 +156,199 @@ std::optional<Uint32> Editor::get_color_at_point(int x, int y) {
 	return std::nullopt;
 }
 
-void Editor::createTileSheet(SurfaceWindow& graphics, int size) {
+void Editor::createTileSheet(SurfaceWindow& graphics, int size, bool sparse) {
+	closeDocument();
+
 	int width, height;
 	graphics.get_window_size(width, height);
-	canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2, size, size));
+	canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2, size, size, sparse));
 
 	canvas_tile_size_ = size;
 
 	editor_mode_ = TILE_SHEET;
+	tile_map_renderer_.reset();
 }
 
 void Editor::createTileMap(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, std::string& tile_sheet_name, int x_count, int y_count) {
+	closeDocument();
+
 	std::ifstream file(tile_sheet_name + ".txt");
 	std::string size;
 	std::getline(file, size);
 
 	int width, height;
 	graphics.get_window_size(width, height);
-	canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2, stoi(size) * x_count, stoi(size) * y_count));
+	canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2, stoi(size) * x_count, stoi(size) * y_count, true));
 	palette_.reset();
+	palette_invalidated_ = true;
 
 	choosed_tile_row_ = 0;
 	choosed_tile_col_ = 0;
 	canvas_tile_size_ = stoi(size);
 
 	editor_mode_ = TILE_MAP;
+	tile_map_renderer_.reset(new TileMapRenderer(graphics.get_pixel_pool(), tile_cache_budget_));
 	loadTileSheetAsPalette(graphics_palette, tile_sheet_name);
 
-	tile_grid_ = std::vector<std::vector<int>>(y_count, std::vector<int>(x_count, int()));
-	for (size_t row = 0; row < tile_grid_.size(); ++row) {
-		for (size_t col = 0; col < tile_grid_[row].size(); ++col) {
-			tile_grid_[row][col] = 0;
-		}
-	}
+	tile_grid_ = TileGrid(x_count, y_count, 0);
 }
 
 void Editor::createPalette(SurfaceWindow& graphics) {
 	if (editor_mode_ == TILE_SHEET) {
-		palette_.reset(new Canvas(graphics, kPaletteSize.left() * 1.0f, kPaletteSize.top() * 1.0f, kPaletteSize.width(), kPaletteSize.height()));
+		palette_.reset(new Canvas(graphics, kPaletteSize.left() * 1.0f, kPaletteSize.top() * 1.0f, kPaletteSize.width(), kPaletteSize.height(), false));
 		palette_->scale(kPaletteStartScale, kPaletteSize.left(), kPaletteSize.top());
 	}
 }
 
-void Editor::saveCanvas(SurfaceWindow& graphics, const std::string& file_path) {
+void Editor::saveCanvas(const std::string& file_path) {
 	if (canvas_) {
-		canvas_->save(graphics, file_path + ".bmp");
-
-		SDL_RWops* io = SDL_RWFromFile((file_path + ".txt").c_str(), "w+");
-		
-		if (editor_mode_ == TILE_SHEET) {
-			std::string str = std::to_string(canvas_tile_size_);
-
-			int tile_index = 0;
-			for (int y = 0; y < canvas_->get_height(); y += canvas_tile_size_) {
-				for (int x = 0; x < canvas_->get_width(); x += canvas_tile_size_) {
-					str += "\n" + std::to_string(tile_index) + ": ";
-					for (int x_world = 0; x_world < canvas_tile_size_; ++x_world) {
-						for (int y_world = 0; y_world < canvas_tile_size_; ++y_world) {
-							SDL_Surface* sprite_sheet = canvas_->get_surface();
-							Uint8* pixel_array = (Uint8*)sprite_sheet->pixels_;
-							Uint8 red = pixel_array[(y + y_world) * sprite_sheet->pitch + (x + x_world) * sprite_sheet->format->BytesPerPixel + 2];
-							Uint8 green = pixel_array[(y + y_world) * sprite_sheet->pitch + (x + x_world) * sprite_sheet->format->BytesPerPixel + 1];
-							Uint8 blue = pixel_array[(y + y_world) * sprite_sheet->pitch + (x + x_world) * sprite_sheet->format->BytesPerPixel + 0];
-
-							if (SDL_MapRGB(sprite_sheet->format, red, green, blue) != SDL_MapRGB(sprite_sheet->format, 0, 0, 0)) {
-								str += std::to_string(canvas_tile_size_ - y_world) + " ";
-								break;
-							} else if (y_world == canvas_tile_size_ - 1) {
-								str += std::to_string(0) + " ";
-							}
-						}
- 					}
-					++tile_index;
-				}
-			}
+		std::unique_ptr<SaveJob> job(new SaveJob());
+		job->file_path = file_path;
+		job->tile_size = canvas_tile_size_;
+		job->distance_field_size = distance_field_size_;
+		if (editor_mode_ == TILE_MAP) {
+			tile_grid_.detach();
+			job->tile_grid = tile_grid_;
+			job->sheet_name = tile_sheet_name_;
+		}
 
-			size_t length = SDL_strlen(str.c_str());
-			SDL_RWwrite(io, str.c_str(), 1, length);
-		} else if (editor_mode_ == TILE_MAP) {
-			std::string str = std::to_string(canvas_tile_size_) + "\n";
+		if (editor_mode_ == TILE_MAP && palette_) {
+			job->kind = SaveJob::TILE_MAP;
+			job->pixels = palette_->snapshot();
+		} else {
+			job->kind = editor_mode_ == TILE_MAP ? SaveJob::BAKED_TILE_MAP : SaveJob::TILE_SHEET;
+			job->pixels = canvas_->snapshot();
+		}
 
-			for (size_t row = 0; row < tile_grid_.size(); ++row) {
-				for (size_t col = 0; col < tile_grid_[row].size(); ++col) {
-					str += std::to_string(tile_grid_[row][col]);
-				}
-				str += "\n";
+		if (file_path != document_path_) {
+			journal_.close();
+			if (!document_path_.empty()) {
+				job->obsolete_files.push_back(document_path_ + kJournalExtension);
+				job->obsolete_files.push_back(document_path_ + kJournalArchiveExtension);
 			}
-
-			size_t length = SDL_strlen(str.c_str());
-			SDL_RWwrite(io, str.c_str(), 1, length);
+			startJournal(file_path, true);
 		}
+		if (!save_worker_.isBusy() && journal_.rotate(file_path + kJournalArchiveExtension)) {
+			job->obsolete_files.push_back(file_path + kJournalArchiveExtension);
+		}
+		save_worker_.submit(std::move(job));
+	}
+}
+
+void Editor::collectSaves() {
+	save_worker_.collect();
+}
 
-		SDL_RWclose(io);
+void Editor::updateJournal() {
+	if (!journal_.isOpen())
+		return;
+
+	const Uint32 ticks = SDL_GetTicks();
+	if (journal_.hasPendingRecords() && ticks - journal_synced_ticks_ >= kJournalSyncInterval) {
+		journal_.flush();
+		journal_synced_ticks_ = ticks;
+	}
+	if (journal_.get_records() >= kJournalCompactionRecords && !save_worker_.isBusy()) {
+		saveCanvas(document_path_);
 	}
 }
 
-void Editor::loadTileSheetAsCanvas(SurfaceWindow& graphics, const std::string& file_path) {
+void Editor::loadTileSheetAsCanvas(SurfaceWindow& graphics, const std::string& file_path, bool recover_journal) {
+	closeDocument();
+
 	int width, height;
 	graphics.get_window_size(width, height);
 	canvas_.reset(new Canvas(graphics, file_path, width * 1.0f / 2, height * 1.0f / 2));
 	palette_.reset();
+	palette_invalidated_ = true;
 
 	editor_mode_ = TILE_SHEET;
+	tile_map_renderer_.reset();
 
 	std::ifstream file(file_path + ".txt");
 	std::string size;
 	std::getline(file, size);
 	canvas_tile_size_ = stoi(size);
+
+	openDocument(file_path, recover_journal);
 }
 
-void Editor::loadTileMap(SurfaceWindow& graphics, const std::string& file_path) {
+void Editor::loadTileMap(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, const std::string& file_path, bool recover_journal) {
+	MapFile map_file;
+	if (!map_file.load(file_path + ".map") && !map_file.loadLegacyText(file_path + ".txt"))
+		return;
+	closeDocument();
+
 	int width, height;
 	graphics.get_window_size(width, height);
-	canvas_.reset(new Canvas(graphics, file_path, width * 1.0f / 2, height * 1.0f / 2));
+	canvas_tile_size_ = map_file.get_tile_size();
+	tile_grid_ = map_file.get_tile_grid();
+	tile_sheet_name_ = map_file.get_sheet_name();
+	if (tile_sheet_name_.empty()) {
+		canvas_.reset(new Canvas(graphics, file_path, width * 1.0f / 2, height * 1.0f / 2));
+	} else {
+		canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2,
+			tile_grid_.get_columns() * canvas_tile_size_, tile_grid_.get_rows() * canvas_tile_size_, true));
+	}
 	palette_.reset();
+	palette_invalidated_ = true;
 
 	editor_mode_ = TILE_MAP;
+	tile_map_renderer_.reset(new TileMapRenderer(graphics.get_pixel_pool(), tile_cache_budget_));
+	if (!tile_sheet_name_.empty()) {
+		loadTileSheetAsPalette(graphics_palette, tile_sheet_name_);
+	}
 
-	std::ifstream file(file_path + ".txt");
-	std::string line;
-	std::getline(file, line);
-	canvas_tile_size_ = stoi(line);
-
-	for (line; std::getline(file, line);) {
-		std::vector<int> row;
-		for (size_t i = 0; i < line.size(); ++i) {
-			if ((char*)line[i] != " ") {
-				row.push_back(line[i] - '0');
-			}
-		}
-		tile_grid_.push_back(row);
+	openDocument(file_path, recover_journal);
+}
+
+bool Editor::convertLegacyTileMap(const std::string& file_path) {
+	if (file_path == document_path_)
+		return false;
+
+	MapFile map_file;
+	return map_file.loadLegacyText(file_path + ".txt") && map_file.save(file_path + ".map");
+}
+
+void Editor::importLevelImage(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, const std::string& file_path, int tile_size) {
+	SDL_Surface* image = graphics.loadUncachedImage(file_path);
+	if (!image || image->w <= 0 || image->h <= 0 || tile_size <= 0) {
+		SDL_FreeSurface(image);
+		return;
 	}
+	closeDocument();
+
+	const ChunkedSurface level(graphics.get_pixel_pool(), image);
+	SDL_FreeSurface(image);
+	const TileImporter tile_importer(level, tile_size);
+	palette_.reset(new Canvas(graphics_palette, kPaletteSize.left() * 1.0f, kPaletteSize.top() * 1.0f,
+		tile_importer.get_sheet_width(), tile_importer.get_sheet_height(), false));
+	for (int i = 0; i < tile_importer.get_sheet_tile_count(); ++i) {
+		const SDL_Point position = tile_importer.get_sheet_position(i);
+		palette_->copyFrom(level, tile_importer.get_source_rectangle(i), position.x, position.y);
+	}
+	palette_invalidated_ = true;
+
+	int width, height;
+	graphics.get_window_size(width, height);
+	canvas_tile_size_ = tile_size;
+	tile_grid_ = tile_importer.get_tile_grid();
+	tile_sheet_name_ = file_path + kImportedSheetSuffix;
+	canvas_.reset(new Canvas(graphics, width * 1.0f / 2, height * 1.0f / 2,
+		tile_grid_.get_columns() * canvas_tile_size_, tile_grid_.get_rows() * canvas_tile_size_, true));
+
+	choosed_tile_row_ = 0;
+	choosed_tile_col_ = 0;
+	editor_mode_ = TILE_MAP;
+	tile_map_renderer_.reset(new TileMapRenderer(graphics.get_pixel_pool(), tile_cache_budget_));
+
+	std::unique_ptr<SaveJob> job(new SaveJob());
+	job->kind = SaveJob::TILE_SHEET;
+	job->file_path = tile_sheet_name_;
+	job->pixels = palette_->snapshot();
+	job->tile_size = canvas_tile_size_;
+	job->distance_field_size = distance_field_size_;
+	save_worker_.submit(std::move(job));
 }
 
 void Editor::loadTileSheetAsPalette(SurfaceWindow& graphics, const std::string& file_path) {
@@ -273,72 +357,295 @@ void Editor::loadTileSheetAsPalette(SurfaceWindow& graphics, const std::string&
 	}
 	palette_.reset(new Canvas(graphics, file_path, kPaletteSize.left() * 1.0f, kPaletteSize.top() * 1.0f));
 	editor_mode_ = TILE_MAP;
+	tile_sheet_name_ = file_path;
+	tile_duplicates_.reset();
+	tile_grid_.reserveIndexRange((palette_->get_width() / canvas_tile_size_) * (palette_->get_height() / canvas_tile_size_));
+	canvas_->discardPixels();
+	tile_map_renderer_->invalidate();
 }
 
-void Editor::extendCanvasX(SurfaceWindow& graphics) {
-	if (canvas_) {
-		canvas_->changeSize(graphics, canvas_tile_size_, 0);
-		canvas_->snapToBounds(kCanvasBounds);
+void Editor::exportTrimmedMap(SurfaceWindow& graphics, const std::string& file_path) {
+	if (editor_mode_ == TILE_MAP && palette_) {
+		tile_grid_.detach();
+		submitTrimmedExport(graphics, palette_->get_surface(), canvas_tile_size_,
+			std::vector<TileGrid>(1, tile_grid_), std::vector<std::string>(1, file_path + kTrimmedMapSuffix), file_path + kAtlasSuffix);
+	}
+}
 
-		if (editor_mode_ == TILE_MAP) {
-			const int height = canvas_->get_height() / canvas_tile_size_;
-			for (int i = 0; i < height; ++i) {
-				tile_grid_[i].push_back(0);
-			}
+bool Editor::exportTrimmedMaps(SurfaceWindow& graphics, const std::vector<std::string>& map_paths, const std::string& atlas_path) {
+	std::vector<TileGrid> tile_grids;
+	std::vector<std::string> trimmed_paths;
+	std::string sheet_name;
+	int tile_size = 0;
+	for (size_t i = 0; i < map_paths.size(); ++i) {
+		MapFile map_file;
+		if (!map_file.load(map_paths[i] + ".map"))
+			return false;
+		if (tile_grids.empty()) {
+			sheet_name = map_file.get_sheet_name();
+			tile_size = map_file.get_tile_size();
+		} else if (map_file.get_sheet_name() != sheet_name || map_file.get_tile_size() != tile_size) {
+			return false;
 		}
+		tile_grids.push_back(map_file.get_tile_grid());
+		trimmed_paths.push_back(map_paths[i] + kTrimmedMapSuffix);
 	}
+	if (tile_grids.empty() || sheet_name.empty() || tile_size <= 0)
+		return false;
+
+	SDL_Surface* image = graphics.loadUncachedImage(sheet_name);
+	if (!image)
+		return false;
+	const ChunkedSurface sheet(graphics.get_pixel_pool(), image);
+	SDL_FreeSurface(image);
+	return submitTrimmedExport(graphics, sheet, tile_size, tile_grids, trimmed_paths, atlas_path);
 }
 
-void Editor::extendCanvasY(SurfaceWindow& graphics) {
-	if (canvas_) {
-		canvas_->changeSize(graphics, 0, canvas_tile_size_);
-		canvas_->snapToBounds(kCanvasBounds);
+void Editor::findDuplicateTiles(int max_distance) {
+	const Canvas* sheet = editor_mode_ == TILE_MAP ? palette_.get() : canvas_.get();
+	if (!sheet || editor_mode_ == NONE) {
+		tile_duplicates_.reset();
+		return;
+	}
+	tile_duplicates_.reset(new TileDuplicates(sheet->get_surface(), canvas_tile_size_, max_distance));
+}
 
-		if (editor_mode_ == TILE_MAP) {
-			const int width = canvas_->get_width() / canvas_tile_size_;
-			std::vector<int> new_col;
-			for (int i = 0; i < width; ++i) {
-				new_col.push_back(0);
-			}
-			tile_grid_.push_back(new_col);
+void Editor::mergeDuplicateTiles(size_t group_index) {
+	if (canMergeDuplicateTiles() && group_index < tile_duplicates_->get_groups().size()) {
+		const std::vector<size_t> group_indices(1, group_index);
+		remapTiles(tile_duplicates_->remapping(group_indices));
+		tile_duplicates_->removeGroups(group_indices);
+	}
+}
+
+void Editor::mergeAllDuplicateTiles() {
+	if (canMergeDuplicateTiles()) {
+		std::vector<size_t> group_indices(tile_duplicates_->get_groups().size());
+		for (size_t i = 0; i < group_indices.size(); ++i) {
+			group_indices[i] = i;
 		}
+		remapTiles(tile_duplicates_->remapping(group_indices));
+		tile_duplicates_->removeGroups(group_indices);
+	}
+}
+
+const std::vector<TileDuplicates::Group>& Editor::get_duplicate_groups() const {
+	static const std::vector<TileDuplicates::Group> kNoGroups;
+	return tile_duplicates_ ? tile_duplicates_->get_groups() : kNoGroups;
+}
+
+void Editor::extendCanvasX() {
+	if (canvas_) {
+		resizeCanvas(canvas_->get_width() + canvas_tile_size_, canvas_->get_height());
 	}
 }
 
-void Editor::truncateCanvasX(SurfaceWindow& graphics) {
+void Editor::extendCanvasY() {
+	if (canvas_) {
+		resizeCanvas(canvas_->get_width(), canvas_->get_height() + canvas_tile_size_);
+	}
+}
+
+void Editor::truncateCanvasX() {
 	if (canvas_) {
 		if (canvas_->get_width() == canvas_tile_size_)
 			return;
 
-		canvas_->changeSize(graphics, -canvas_tile_size_, 0);
-		canvas_->snapToBounds(kCanvasBounds);
-
-		if (editor_mode_ == TILE_MAP) {
-			const int height = canvas_->get_height() / canvas_tile_size_;
-			for (int i = 0; i < height; ++i) {
-				tile_grid_[i].pop_back();
-			}
-		}
+		resizeCanvas(canvas_->get_width() - canvas_tile_size_, canvas_->get_height());
 	}
 }
 
-void Editor::truncateCanvasY(SurfaceWindow& graphics) {
+void Editor::truncateCanvasY() {
 	if (canvas_) {
 		if (canvas_->get_height() == canvas_tile_size_)
 			return;
 
-		canvas_->changeSize(graphics, 0, -canvas_tile_size_);
-		canvas_->snapToBounds(kCanvasBounds);
+		resizeCanvas(canvas_->get_width(), canvas_->get_height() - canvas_tile_size_);
+	}
+}
 
-		if (editor_mode_ == TILE_MAP) {
-			tile_grid_.pop_back();
+void Editor::restoreSession(SurfaceWindow& graphics, SurfaceWindow& graphics_palette) {
+	std::ifstream file(kSessionPath);
+	std::string mode, file_path;
+	if (!std::getline(file, mode) || !std::getline(file, file_path))
+		return;
+
+	if (mode == "map") {
+		if (std::ifstream(file_path + ".map") || std::ifstream(file_path + ".bmp")) {
+			loadTileMap(graphics, graphics_palette, file_path, true);
 		}
+	} else if (std::ifstream(file_path + ".bmp")) {
+		loadTileSheetAsCanvas(graphics, file_path, true);
+	}
+}
+
+void Editor::set_tile_cache_budget(size_t budget_bytes) {
+	tile_cache_budget_ = budget_bytes;
+	if (tile_map_renderer_) {
+		tile_map_renderer_->get_cache().set_budget(budget_bytes);
+	}
+}
+
+const TileChunkCache* Editor::get_tile_chunk_cache() const {
+	return tile_map_renderer_ ? &tile_map_renderer_->get_cache() : nullptr;
+}
+
+void Editor::openDocument(const std::string& file_path, bool recover_journal) {
+	if (recover_journal) {
+		std::vector<Journal::Record> records;
+		Journal::read(file_path + kJournalArchiveExtension, records);
+		Journal::read(file_path + kJournalExtension, records);
+		replayJournal(records);
+	}
+
+	startJournal(file_path, !recover_journal);
+}
+
+void Editor::startJournal(const std::string& file_path, bool discard_records) {
+	if (discard_records) {
+		discardJournal(file_path);
+	}
+	std::vector<Journal::Record> records;
+	journal_.open(file_path + kJournalExtension, records);
+	journal_synced_ticks_ = SDL_GetTicks();
+	document_path_ = file_path;
+
+	BufferedWriter writer(kSessionPath);
+	writer.write(editor_mode_ == TILE_MAP ? "map\n" : "sheet\n");
+	writer.write(file_path.c_str());
+	writer.close();
+}
+
+void Editor::discardJournal(const std::string& file_path) {
+	std::remove((file_path + kJournalExtension).c_str());
+	std::remove((file_path + kJournalArchiveExtension).c_str());
+}
+
+void Editor::closeDocument() {
+	tile_duplicates_.reset();
+	journal_.close();
+	document_path_.clear();
+	std::remove(kSessionPath);
+}
+
+void Editor::replayJournal(const std::vector<Journal::Record>& records) {
+	for (size_t i = 0; i < records.size(); ++i) {
+		const Journal::Record& record = records[i];
+		switch (record.type) {
+		case Journal::PIXEL:
+			if (editor_mode_ == TILE_SHEET) {
+				canvas_->setPixel(record.a, record.b, record.c);
+			}
+			break;
+		case Journal::TILE:
+			if (editor_mode_ == TILE_MAP && record.a >= 0 && record.a < tile_grid_.get_columns() && record.b >= 0 && record.b < tile_grid_.get_rows()) {
+				tile_grid_.set(record.a, record.b, int(record.c));
+			}
+			break;
+		case Journal::RESIZE:
+			if (record.a > 0 && record.b > 0) {
+				resizeCanvas(record.a, record.b);
+			}
+			break;
+		}
+	}
+
+	if (!records.empty()) {
+		canvas_->invalidate();
+		if (tile_map_renderer_) {
+			tile_map_renderer_->invalidate();
+		}
+	}
+}
+
+void Editor::remapTiles(const std::vector<int>& tiles) {
+	bool remapped = false;
+	for (int row = 0; row < tile_grid_.get_rows(); ++row) {
+		for (int column = 0; column < tile_grid_.get_columns(); ++column) {
+			const int tile_index = tile_grid_.get(column, row);
+			if (tile_index >= 0 && tile_index < (int)tiles.size() && tiles[tile_index] != tile_index) {
+				tile_grid_.set(column, row, tiles[tile_index]);
+				journal_.append(Journal::TILE, column, row, Uint32(tiles[tile_index]));
+				remapped = true;
+			}
+		}
+	}
+
+	if (remapped) {
+		canvas_->invalidate();
+		tile_map_renderer_->invalidate();
+	}
+}
+
+bool Editor::submitTrimmedExport(SurfaceWindow& graphics, const ChunkedSurface& sheet, int tile_size,
+	const std::vector<TileGrid>& tile_grids, const std::vector<std::string>& map_paths, const std::string& atlas_path) {
+	if (std::find(map_paths.begin(), map_paths.end(), document_path_) != map_paths.end())
+		return false;
+
+	const TileTrimmer tile_trimmer(tile_grids, (sheet.get_width() / tile_size) * (sheet.get_height() / tile_size));
+	if (tile_trimmer.get_used_tile_count() == 0)
+		return false;
+
+	std::shared_ptr<ChunkedSurface> atlas(new ChunkedSurface(graphics.get_pixel_pool(),
+		tile_trimmer.get_atlas_width(tile_size), tile_trimmer.get_atlas_height(tile_size), sheet.get_fill_pixel(), false));
+	tile_trimmer.copyAtlas(sheet, tile_size, *atlas);
+
+	std::unique_ptr<SaveJob> atlas_job(new SaveJob());
+	atlas_job->kind = SaveJob::TILE_SHEET;
+	atlas_job->file_path = atlas_path;
+	atlas_job->pixels = atlas;
+	atlas_job->tile_size = tile_size;
+	atlas_job->distance_field_size = distance_field_size_;
+	save_worker_.submit(std::move(atlas_job));
+
+	for (size_t i = 0; i < tile_grids.size(); ++i) {
+		std::unique_ptr<SaveJob> map_job(new SaveJob());
+		map_job->kind = SaveJob::MAP_FILE;
+		map_job->file_path = map_paths[i];
+		map_job->pixels = atlas;
+		map_job->tile_grid = tile_trimmer.remap(tile_grids[i]);
+		map_job->tile_size = tile_size;
+		map_job->distance_field_size = distance_field_size_;
+		map_job->sheet_name = atlas_path;
+		save_worker_.submit(std::move(map_job));
+	}
+	return true;
+}
+
+void Editor::resizeCanvas(int width, int height) {
+	if (editor_mode_ == TILE_SHEET) {
+		tile_duplicates_.reset();
+	}
+	canvas_->resize(width, height);
+	canvas_->snapToBounds(kCanvasBounds);
+
+	if (editor_mode_ == TILE_MAP) {
+		tile_grid_.resize(width / canvas_tile_size_, height / canvas_tile_size_, 0);
+		tile_map_renderer_->invalidate();
+	}
+	journal_.append(Journal::RESIZE, width, height, 0);
+}
+
+void Editor::submitDamage(SurfaceWindow& graphics, SurfaceWindow& graphics_palette) {
+	if (canvas_) {
+		canvas_->submitDamage(graphics);
+	}
+	if (palette_) {
+		palette_->submitDamage(graphics_palette);
+	}
+	if (palette_invalidated_) {
+		graphics_palette.invalidate();
+		palette_invalidated_ = false;
 	}
 }
 
 void Editor::draw(SurfaceWindow& graphics, SurfaceWindow& graphics_palette) const {
 	if (canvas_) {
-		canvas_->draw(graphics);
+		if (editor_mode_ == TILE_MAP && palette_) {
+			tile_map_renderer_->draw(graphics, *canvas_, *palette_, tile_grid_, canvas_tile_size_);
+		} else {
+			canvas_->draw(graphics);
+		}
 		canvas_->drawGrid(graphics, canvas_tile_size_, canvas_tile_size_);
 	}
 	if (palette_) {
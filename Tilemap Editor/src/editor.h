@@ -6,14 +6,21 @@
 #include <string>
 #include <vector>
 
+#include "journal.h"
 #include "rectangle.h"
+#include "save_worker.h"
+#include "tile_duplicates.h"
+#include "tile_grid.h"
+#include "tile_map_renderer.h"
 
 struct SurfaceWindow;
 struct Canvas;
 struct Sprite;
+struct ChunkedSurface;
 
 struct Editor {
 	Editor();
+	~Editor();
 
 	void startMove(int x, int y);
 	void move(int x, int y, int previous_x, int previous_y);
@@ -23,21 +30,56 @@ struct Editor {
 	void putPixel(Uint32 color, int x, int y);
 	std::optional<Uint32> get_color_at_point(int x, int y);
 
-	void createTileSheet(SurfaceWindow& graphics, int size);
+	void createTileSheet(SurfaceWindow& graphics, int size, bool sparse);
 	void createTileMap(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, std::string& tile_sheet_name, int x_count, int y_count);
 	void createPalette(SurfaceWindow& graphics);
-	void saveCanvas(SurfaceWindow& graphics, const std::string& file_path);
-	void loadTileSheetAsCanvas(SurfaceWindow& graphics, const std::string& file_path);
-	void loadTileMap(SurfaceWindow& graphics, const std::string& file_path);
+	void saveCanvas(const std::string& file_path);
+	void loadTileSheetAsCanvas(SurfaceWindow& graphics, const std::string& file_path, bool recover_journal);
+	void loadTileMap(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, const std::string& file_path, bool recover_journal);
+	bool convertLegacyTileMap(const std::string& file_path);
+	void importLevelImage(SurfaceWindow& graphics, SurfaceWindow& graphics_palette, const std::string& file_path, int tile_size);
 	void loadTileSheetAsPalette(SurfaceWindow& graphics, const std::string& file_path);
+	void restoreSession(SurfaceWindow& graphics, SurfaceWindow& graphics_palette);
 
-	void extendCanvasX(SurfaceWindow& graphics);
-	void extendCanvasY(SurfaceWindow& graphics);
-	void truncateCanvasX(SurfaceWindow& graphics);
-	void truncateCanvasY(SurfaceWindow& graphics);
+	void exportTrimmedMap(SurfaceWindow& graphics, const std::string& file_path);
+	bool exportTrimmedMaps(SurfaceWindow& graphics, const std::vector<std::string>& map_paths, const std::string& atlas_path);
 
+	void findDuplicateTiles(int max_distance);
+	void mergeDuplicateTiles(size_t group_index);
+	void mergeAllDuplicateTiles();
+	const std::vector<TileDuplicates::Group>& get_duplicate_groups() const;
+	bool canMergeDuplicateTiles() const { return editor_mode_ == TILE_MAP && tile_duplicates_ != nullptr; }
+
+	void extendCanvasX();
+	void extendCanvasY();
+	void truncateCanvasX();
+	void truncateCanvasY();
+
+	void set_tile_cache_budget(size_t budget_bytes);
+	size_t get_tile_cache_budget() const { return tile_cache_budget_; }
+	const TileChunkCache* get_tile_chunk_cache() const;
+
+	void set_distance_field_size(int distance_field_size) { distance_field_size_ = distance_field_size; }
+	int get_distance_field_size() const { return distance_field_size_; }
+
+	void collectSaves();
+	void updateJournal();
+	bool hasPendingJournal() const { return journal_.hasPendingRecords(); }
+	const SaveWorker& get_save_worker() const { return save_worker_; }
+
+	void submitDamage(SurfaceWindow& graphics, SurfaceWindow& graphics_palette);
 	void draw(SurfaceWindow& graphics, SurfaceWindow& graphics_palette) const;
 private:
+	void openDocument(const std::string& file_path, bool recover_journal);
+	void startJournal(const std::string& file_path, bool discard_records);
+	void discardJournal(const std::string& file_path);
+	void closeDocument();
+	void replayJournal(const std::vector<Journal::Record>& records);
+	void resizeCanvas(int width, int height);
+	void remapTiles(const std::vector<int>& tiles);
+	bool submitTrimmedExport(SurfaceWindow& graphics, const ChunkedSurface& sheet, int tile_size,
+		const std::vector<TileGrid>& tile_grids, const std::vector<std::string>& map_paths, const std::string& atlas_path);
+
 	std::shared_ptr<Canvas> canvas_;
 	std::shared_ptr<Canvas> palette_;
 
@@ -49,5 +91,15 @@ private:
 	EditorMode editor_mode_;
 	int canvas_tile_size_;
 	float choosed_tile_row_, choosed_tile_col_;
-	std::vector<std::vector<int>> tile_grid_;
+	TileGrid tile_grid_;
+	std::string tile_sheet_name_;
+	std::shared_ptr<TileMapRenderer> tile_map_renderer_;
+	std::unique_ptr<TileDuplicates> tile_duplicates_;
+	size_t tile_cache_budget_;
+	int distance_field_size_;
+	bool palette_invalidated_;
+	SaveWorker save_worker_;
+	Journal journal_;
+	std::string document_path_;
+	Uint32 journal_synced_ticks_;
 };
\ No newline at end of file
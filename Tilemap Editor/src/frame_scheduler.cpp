@@ -0,0 +1,26 @@
+#include "frame_scheduler.h"
+
+FrameScheduler::FrameScheduler(int frame_rate_cap, int idle_timeout) :
+	last_frame_counter_(SDL_GetPerformanceCounter()),
+	frame_rate_cap_(frame_rate_cap),
+	idle_timeout_(idle_timeout),
+	idle_enabled_(true) {
+}
+
+void FrameScheduler::waitForEvents(bool busy) {
+	if (idle_enabled_ && !busy) {
+		SDL_WaitEventTimeout(NULL, idle_timeout_);
+	}
+}
+
+void FrameScheduler::limitFrameRate() {
+	if (frame_rate_cap_ > 0) {
+		const Uint64 frequency = SDL_GetPerformanceFrequency();
+		const Uint64 frame_duration = frequency / frame_rate_cap_;
+		const Uint64 elapsed = SDL_GetPerformanceCounter() - last_frame_counter_;
+		if (elapsed < frame_duration) {
+			SDL_Delay(Uint32((frame_duration - elapsed) * 1000 / frequency));
+		}
+	}
+	last_frame_counter_ = SDL_GetPerformanceCounter();
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <SDL.h>
+
+struct FrameScheduler {
+	FrameScheduler(int frame_rate_cap, int idle_timeout);
+
+	void waitForEvents(bool busy);
+	void limitFrameRate();
+
+	void set_frame_rate_cap(int frame_rate_cap) { frame_rate_cap_ = frame_rate_cap; }
+	void set_idle_enabled(bool idle_enabled) { idle_enabled_ = idle_enabled; }
+private:
+	Uint64 last_frame_counter_;
+	int frame_rate_cap_;
+	int idle_timeout_;
+	bool idle_enabled_;
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "grid_overlay.h"
+
+#include <algorithm>
+#include <cmath>
+
+GridOverlay::GridOverlay() :
+	x_offset_(0), y_offset_(0),
+	scale_x_(1), scale_y_(1),
+	width_(0), height_(0),
+	cell_width_(0), cell_height_(0),
+	bounds_(),
+	valid_(false) {
+}
+
+bool GridOverlay::update(float x_offset, float y_offset, float scale_x, float scale_y, int width, int height, int cell_width, int cell_height, const SDL_Rect& bounds) {
+	if (valid_ && x_offset == x_offset_ && y_offset == y_offset_ && scale_x == scale_x_ && scale_y == scale_y_ &&
+		width == width_ && height == height_ && cell_width == cell_width_ && cell_height == cell_height_ &&
+		bounds.x == bounds_.x && bounds.y == bounds_.y && bounds.w == bounds_.w && bounds.h == bounds_.h)
+		return false;
+
+	x_offset_ = x_offset;
+	y_offset_ = y_offset;
+	scale_x_ = scale_x;
+	scale_y_ = scale_y;
+	width_ = width;
+	height_ = height;
+	cell_width_ = cell_width;
+	cell_height_ = cell_height;
+	bounds_ = bounds;
+	valid_ = true;
+	rebuild();
+	return true;
+}
+
+void GridOverlay::rebuild() {
+	rectangles_.clear();
+	if (cell_width_ <= 0 || cell_height_ <= 0 || width_ <= 0 || height_ <= 0)
+		return;
+
+	const int columns = (width_ + cell_width_ - 1) / cell_width_;
+	const int rows = (height_ + cell_height_ - 1) / cell_height_;
+	const int bounds_right = bounds_.x + bounds_.w;
+	const int bounds_bottom = bounds_.y + bounds_.h;
+
+	const int top = std::max(screenY(0), bounds_.y);
+	const int bottom = std::min(screenY(float(rows * cell_height_)), bounds_bottom);
+	const int left = std::max(screenX(0), bounds_.x);
+	const int right = std::min(screenX(float(columns * cell_width_)), bounds_right);
+	if (top >= bottom || left >= right)
+		return;
+
+	const int first_column = std::max(int(floor((bounds_.x / scale_x_ - x_offset_) / cell_width_)) - 1, 0);
+	for (int column = first_column; column < columns; ++column) {
+		const int x = screenX(float(column * cell_width_));
+		if (x >= bounds_right)
+			break;
+		if (x < bounds_.x)
+			continue;
+		SDL_Rect rectangle = { x, top, 1, bottom - top };
+		rectangles_.push_back(rectangle);
+	}
+
+	const int first_row = std::max(int(floor((bounds_.y / scale_y_ - y_offset_) / cell_height_)) - 1, 0);
+	for (int row = first_row; row < rows; ++row) {
+		const int y = screenY(float(row * cell_height_));
+		if (y >= bounds_bottom)
+			break;
+		if (y < bounds_.y)
+			continue;
+		SDL_Rect rectangle = { left, y, right - left, 1 };
+		rectangles_.push_back(rectangle);
+	}
+}
+
+int GridOverlay::screenX(float world_x) const {
+	return int(floor((world_x + x_offset_) * scale_x_));
+}
+
+int GridOverlay::screenY(float world_y) const {
+	return int(floor((world_y + y_offset_) * scale_y_));
+}
\ No newline at end of file
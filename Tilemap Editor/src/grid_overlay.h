@@ -0,0 +1,24 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+struct GridOverlay {
+	GridOverlay();
+
+	bool update(float x_offset, float y_offset, float scale_x, float scale_y, int width, int height, int cell_width, int cell_height, const SDL_Rect& bounds);
+
+	const std::vector<SDL_Rect>& get_rectangles() const { return rectangles_; }
+private:
+	void rebuild();
+	int screenX(float world_x) const;
+	int screenY(float world_y) const;
+
+	std::vector<SDL_Rect> rectangles_;
+	float x_offset_, y_offset_;
+	float scale_x_, scale_y_;
+	int width_, height_;
+	int cell_width_, cell_height_;
+	SDL_Rect bounds_;
+	bool valid_;
+};
\ No newline at end of file
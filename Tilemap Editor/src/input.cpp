@@ -58,4 +58,14 @@ bool Input::isMouseButtonPressed(Uint8 index) {
 
 bool Input::wasMouseButtonReleased(Uint8 index) {
 	return released_mouse_buttons_[index];
+}
+
+bool Input::isAnyMouseButtonHeld() const {
+	for (std::map<Uint8, bool>::const_iterator iter = held_mouse_buttons_.begin();
+		iter != held_mouse_buttons_.end();
+		++iter) {
+		if (iter->second)
+			return true;
+	}
+	return false;
 }
\ No newline at end of file
@@ -22,6 +22,7 @@ struct Input {
 	bool wasMouseButtonPressed(Uint8 index);
 	bool isMouseButtonPressed(Uint8 index);
 	bool wasMouseButtonReleased(Uint8 index);
+	bool isAnyMouseButtonHeld() const;
 
 	float getWheelMovement() const { return wheel_movement_; }
 
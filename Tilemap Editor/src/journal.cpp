@@ -0,0 +1,272 @@
+#include "journal.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	const char kMagic[4] = { 'T', 'J', 'R', 'N' };
+	const Uint16 kVersion = 1;
+	const size_t kHeaderSize = Journal::kRecordSize;
+
+	void writeLE32(Uint8* data, Uint32 value) {
+		value = SDL_SwapLE32(value);
+		memcpy(data, &value, sizeof(value));
+	}
+
+	Uint32 readLE32(const Uint8* data) {
+		Uint32 value;
+		memcpy(&value, data, sizeof(value));
+		return SDL_SwapLE32(value);
+	}
+}
+
+Journal::Journal() :
+#ifdef _WIN32
+	file_(INVALID_HANDLE_VALUE),
+#else
+	file_(-1),
+#endif
+	records_(0),
+	writing_(false),
+	failed_(false),
+	stopping_(false),
+	thread_(&Journal::run, this) {
+}
+
+Journal::~Journal() {
+	close();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	condition_.notify_all();
+	thread_.join();
+}
+
+bool Journal::open(const std::string& file_path, std::vector<Record>& records) {
+	close();
+	records.clear();
+	file_path_ = file_path;
+	const size_t size = read(file_path, records);
+	records_ = records.size();
+	return reopen(size);
+}
+
+void Journal::close() {
+	if (isOpen()) {
+		sync();
+		closeFile();
+	}
+	buffer_.clear();
+	records_ = 0;
+}
+
+void Journal::append(RecordType type, int a, int b, Uint32 c) {
+	if (!isOpen())
+		return;
+
+	const size_t offset = buffer_.size();
+	buffer_.resize(offset + kRecordSize);
+	writeLE32(buffer_.data() + offset, Uint32(type));
+	writeLE32(buffer_.data() + offset + 4, Uint32(a));
+	writeLE32(buffer_.data() + offset + 8, Uint32(b));
+	writeLE32(buffer_.data() + offset + 12, c);
+	++records_;
+
+	if (buffer_.size() >= kMaxPendingRecords * kRecordSize) {
+		flush();
+	}
+}
+
+void Journal::flush() {
+	if (!isOpen() || buffer_.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		flushing_.insert(flushing_.end(), buffer_.begin(), buffer_.end());
+	}
+	buffer_.clear();
+	condition_.notify_all();
+}
+
+bool Journal::sync() {
+	if (!isOpen())
+		return false;
+
+	flush();
+	std::unique_lock<std::mutex> lock(mutex_);
+	condition_.wait(lock, [this] { return flushing_.empty() && !writing_; });
+	const bool synced = !failed_;
+	failed_ = false;
+	return synced;
+}
+
+void Journal::run() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		condition_.wait(lock, [this] { return stopping_ || !flushing_.empty(); });
+		if (flushing_.empty())
+			return;
+
+		std::vector<Uint8> data;
+		data.swap(flushing_);
+		writing_ = true;
+		lock.unlock();
+
+		const bool written = writeFile(data.data(), data.size()) && syncFile();
+
+		lock.lock();
+		writing_ = false;
+		failed_ = failed_ || !written;
+		condition_.notify_all();
+	}
+}
+
+bool Journal::rotate(const std::string& archive_path) {
+	if (!sync())
+		return false;
+	closeFile();
+
+	std::vector<Record> records;
+	const size_t size = read(file_path_, records);
+	std::vector<Record> archived;
+	bool rotated;
+	if (read(archive_path, archived) == 0) {
+		std::remove(archive_path.c_str());
+		rotated = std::rename(file_path_.c_str(), archive_path.c_str()) == 0;
+	} else {
+		Journal archive;
+		archive.open(archive_path, archived);
+		for (size_t i = 0; i < records.size(); ++i) {
+			archive.append(records[i].type, records[i].a, records[i].b, records[i].c);
+		}
+		rotated = archive.sync();
+	}
+	if (!rotated) {
+		reopen(size);
+		return false;
+	}
+
+	records_ = 0;
+	return reopen(0);
+}
+
+size_t Journal::read(const std::string& file_path, std::vector<Record>& records) {
+	std::ifstream file(file_path, std::ios::binary);
+	const std::vector<Uint8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	if (data.size() < kHeaderSize || memcmp(data.data(), kMagic, sizeof(kMagic)) != 0 ||
+		SDL_SwapLE16(*(const Uint16*)(data.data() + 4)) != kVersion)
+		return 0;
+
+	size_t offset = kHeaderSize;
+	for (; offset + kRecordSize <= data.size(); offset += kRecordSize) {
+		const Uint32 type = readLE32(data.data() + offset);
+		if (type < PIXEL || type > RESIZE)
+			break;
+
+		Record record;
+		record.type = RecordType(type);
+		record.a = int(readLE32(data.data() + offset + 4));
+		record.b = int(readLE32(data.data() + offset + 8));
+		record.c = readLE32(data.data() + offset + 12);
+		records.push_back(record);
+	}
+	return offset;
+}
+
+bool Journal::isOpen() const {
+#ifdef _WIN32
+	return file_ != INVALID_HANDLE_VALUE;
+#else
+	return file_ >= 0;
+#endif
+}
+
+bool Journal::reopen(size_t size) {
+	if (!openFile(size))
+		return false;
+
+	if (size == 0) {
+		Uint8 header[kHeaderSize] = {};
+		memcpy(header, kMagic, sizeof(kMagic));
+		const Uint16 version = SDL_SwapLE16(kVersion);
+		memcpy(header + 4, &version, sizeof(version));
+		return writeFile(header, kHeaderSize) && syncFile();
+	}
+	return true;
+}
+
+#ifdef _WIN32
+bool Journal::openFile(size_t size) {
+	file_ = CreateFileA(file_path_.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER end;
+	end.QuadPart = (LONGLONG)size;
+	if (!SetFilePointerEx(file_, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file_)) {
+		closeFile();
+		return false;
+	}
+	return true;
+}
+
+bool Journal::writeFile(const Uint8* data, size_t size) {
+	DWORD written;
+	return WriteFile(file_, data, (DWORD)size, &written, nullptr) && written == size;
+}
+
+bool Journal::syncFile() {
+	return FlushFileBuffers(file_) != 0;
+}
+
+void Journal::closeFile() {
+	CloseHandle(file_);
+	file_ = INVALID_HANDLE_VALUE;
+}
+#else
+bool Journal::openFile(size_t size) {
+	file_ = ::open(file_path_.c_str(), O_WRONLY | O_CREAT, 0644);
+	if (file_ < 0)
+		return false;
+
+	if (ftruncate(file_, (off_t)size) != 0 || lseek(file_, (off_t)size, SEEK_SET) < 0) {
+		closeFile();
+		return false;
+	}
+	return true;
+}
+
+bool Journal::writeFile(const Uint8* data, size_t size) {
+	while (size > 0) {
+		const ssize_t written = ::write(file_, data, size);
+		if (written <= 0)
+			return false;
+		data += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+bool Journal::syncFile() {
+	return fsync(file_) == 0;
+}
+
+void Journal::closeFile() {
+	::close(file_);
+	file_ = -1;
+}
+#endif
\ No newline at end of file
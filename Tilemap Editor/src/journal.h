@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Journal {
+	static constexpr size_t kRecordSize = 16;
+	static constexpr size_t kMaxPendingRecords = 4096;
+
+	enum RecordType {
+		PIXEL = 1,
+		TILE = 2,
+		RESIZE = 3
+	};
+
+	struct Record {
+		RecordType type;
+		int a, b;
+		Uint32 c;
+	};
+
+	Journal();
+	~Journal();
+
+	Journal(const Journal&) = delete;
+	Journal& operator=(const Journal&) = delete;
+
+	bool open(const std::string& file_path, std::vector<Record>& records);
+	void close();
+	void append(RecordType type, int a, int b, Uint32 c);
+	void flush();
+	bool sync();
+	bool rotate(const std::string& archive_path);
+
+	static size_t read(const std::string& file_path, std::vector<Record>& records);
+
+	bool isOpen() const;
+	bool hasPendingRecords() const { return !buffer_.empty(); }
+	size_t get_records() const { return records_; }
+	const std::string& get_file_path() const { return file_path_; }
+private:
+	void run();
+	bool reopen(size_t size);
+	bool openFile(size_t size);
+	bool writeFile(const Uint8* data, size_t size);
+	bool syncFile();
+	void closeFile();
+
+	std::string file_path_;
+#ifdef _WIN32
+	void* file_;
+#else
+	int file_;
+#endif
+	std::vector<Uint8> buffer_;
+	size_t records_;
+
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	std::vector<Uint8> flushing_;
+	bool writing_;
+	bool failed_;
+	bool stopping_;
+	std::thread thread_;
+};
\ No newline at end of file
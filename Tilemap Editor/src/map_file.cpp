@@ -0,0 +1,213 @@
+#include "map_file.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#include "buffered_writer.h"
+#include "mapped_file.h"
+
+namespace {
+	const char kMagic[4] = { 'T', 'M', 'A', 'P' };
+	const size_t kHeaderSize = 32;
+	const size_t kChecksumOffset = 20;
+	const size_t kIndexAlignment = 8;
+	const size_t kSectionAlignment = 4;
+	const int kMaxTileSize = 4096;
+	const Uint8 kPadding[kIndexAlignment] = {};
+
+	const Uint32 kChecksumBasis = 2166136261u;
+	const Uint32 kChecksumPrime = 16777619u;
+
+	Uint32 checksum(Uint32 hash, const Uint8* data, size_t size) {
+		for (size_t i = 0; i < size; ++i) {
+			hash = (hash ^ data[i]) * kChecksumPrime;
+		}
+		return hash;
+	}
+
+	size_t align(size_t offset, size_t alignment) {
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	Uint16 readLE16(const Uint8* data) {
+		Uint16 value;
+		memcpy(&value, data, sizeof(value));
+		return SDL_SwapLE16(value);
+	}
+
+	Uint32 readLE32(const Uint8* data) {
+		Uint32 value;
+		memcpy(&value, data, sizeof(value));
+		return SDL_SwapLE32(value);
+	}
+}
+
+MapFile::MapFile() :
+	tile_size_(0) {
+}
+
+bool MapFile::load(const std::string& file_path) {
+	std::shared_ptr<MappedFile> mapped_file(new MappedFile(file_path));
+	const Uint8* data = mapped_file->get_data();
+	const size_t size = mapped_file->get_size();
+	if (!mapped_file->isOpen() || size < kHeaderSize || memcmp(data, kMagic, sizeof(kMagic)) != 0)
+		return false;
+	if (readLE16(data + 4) != kVersion)
+		return false;
+
+	const int index_width = readLE16(data + 6);
+	const Uint32 tile_size = readLE32(data + 8);
+	const Uint32 columns = readLE32(data + 12);
+	const Uint32 rows = readLE32(data + 16);
+	const Uint32 stored_checksum = readLE32(data + kChecksumOffset);
+	const Uint32 sheet_length = readLE32(data + 24);
+	const Uint32 index_offset = readLE32(data + 28);
+	if (index_width != 1 && index_width != 2 && index_width != 4)
+		return false;
+	if (tile_size == 0 || tile_size > Uint32(kMaxTileSize))
+		return false;
+	if (columns > Uint32(INT_MAX) / tile_size || rows > Uint32(INT_MAX) / tile_size)
+		return false;
+	if (kHeaderSize + sheet_length > index_offset || index_offset % kIndexAlignment != 0)
+		return false;
+
+	const size_t index_bytes = size_t(columns) * rows * index_width;
+	if (index_offset > size || index_bytes > size - index_offset)
+		return false;
+	if (checksum(kChecksumBasis, data + index_offset, index_bytes) != stored_checksum)
+		return false;
+
+	std::map<Uint32, std::vector<Uint8>> sections;
+	for (size_t offset = align(index_offset + index_bytes, kSectionAlignment); offset + 8 <= size;) {
+		const Uint32 tag = readLE32(data + offset);
+		const Uint32 length = readLE32(data + offset + 4);
+		if (length > size - offset - 8)
+			return false;
+		sections[tag].assign(data + offset + 8, data + offset + 8 + length);
+		offset = align(offset + 8 + length, kSectionAlignment);
+	}
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	tile_grid_ = TileGrid(mapped_file, index_offset, int(columns), int(rows), index_width);
+#else
+	TileGrid mapped_grid(mapped_file, index_offset, int(columns), int(rows), index_width);
+	tile_grid_ = TileGrid(int(columns), int(rows), 0);
+	for (int row = 0; row < int(rows); ++row) {
+		for (int column = 0; column < int(columns); ++column) {
+			const Uint8* cell = mapped_grid.get_row(row) + column * index_width;
+			tile_grid_.set(column, row, index_width == 1 ? *cell : index_width == 2 ? readLE16(cell) : int(readLE32(cell)));
+		}
+	}
+#endif
+	tile_size_ = int(tile_size);
+	sheet_name_.assign((const char*)data + kHeaderSize, sheet_length);
+	sections_.swap(sections);
+	return true;
+}
+
+bool MapFile::loadLegacyText(const std::string& file_path) {
+	std::ifstream file(file_path);
+	std::string line;
+	if (!std::getline(file, line))
+		return false;
+
+	TileGrid tile_grid;
+	const int tile_size = atoi(line.c_str());
+	if (tile_size <= 0 || tile_size > kMaxTileSize)
+		return false;
+	while (std::getline(file, line)) {
+		std::vector<int> row;
+		for (size_t i = 0; i < line.size(); ++i) {
+			if (line[i] >= '0' && line[i] <= '9') {
+				row.push_back(line[i] - '0');
+			}
+		}
+		if (tile_grid.get_rows() == 0) {
+			tile_grid.insertColumns(0, (int)row.size(), 0);
+		}
+		tile_grid.insertRows(tile_grid.get_rows(), 1, 0);
+		for (int column = 0; column < std::min((int)row.size(), tile_grid.get_columns()); ++column) {
+			tile_grid.set(column, tile_grid.get_rows() - 1, row[column]);
+		}
+	}
+
+	tile_grid_.swap(tile_grid);
+	tile_size_ = tile_size;
+	sheet_name_.clear();
+	sections_.clear();
+	return true;
+}
+
+bool MapFile::save(const std::string& file_path) const {
+	BufferedWriter writer(file_path);
+	if (!writer.isOpen())
+		return false;
+
+	const int index_width = tile_grid_.get_index_width();
+	const size_t index_offset = align(kHeaderSize + sheet_name_.size(), kIndexAlignment);
+	const size_t row_bytes = size_t(tile_grid_.get_columns()) * index_width;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	std::vector<Uint8> row_data;
+#else
+	std::vector<Uint8> row_data(row_bytes);
+#endif
+
+	Uint32 hash = kChecksumBasis;
+	for (int row = 0; row < tile_grid_.get_rows(); ++row) {
+		hash = checksum(hash, rowData(row, row_data), row_bytes);
+	}
+
+	writer.write(kMagic, sizeof(kMagic));
+	writer.writeLE16(kVersion);
+	writer.writeLE16(Uint16(index_width));
+	writer.writeLE32(Uint32(tile_size_));
+	writer.writeLE32(Uint32(tile_grid_.get_columns()));
+	writer.writeLE32(Uint32(tile_grid_.get_rows()));
+	writer.writeLE32(hash);
+	writer.writeLE32(Uint32(sheet_name_.size()));
+	writer.writeLE32(Uint32(index_offset));
+	writer.write(sheet_name_.data(), sheet_name_.size());
+	writer.write(kPadding, index_offset - kHeaderSize - sheet_name_.size());
+
+	for (int row = 0; row < tile_grid_.get_rows(); ++row) {
+		writer.write(rowData(row, row_data), row_bytes);
+	}
+
+	size_t offset = index_offset + row_bytes * tile_grid_.get_rows();
+	for (std::map<Uint32, std::vector<Uint8>>::const_iterator iter = sections_.begin(); iter != sections_.end(); ++iter) {
+		writer.write(kPadding, align(offset, kSectionAlignment) - offset);
+		offset = align(offset, kSectionAlignment);
+		writer.writeLE32(iter->first);
+		writer.writeLE32(Uint32(iter->second.size()));
+		writer.write(iter->second.data(), iter->second.size());
+		offset += 8 + iter->second.size();
+	}
+	return writer.close();
+}
+
+const Uint8* MapFile::rowData(int row, std::vector<Uint8>& row_data) const {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+	(void)row_data;
+	return tile_grid_.get_row(row);
+#else
+	const int index_width = tile_grid_.get_index_width();
+	for (int column = 0; column < tile_grid_.get_columns(); ++column) {
+		const Uint32 value = SDL_SwapLE32(Uint32(tile_grid_.get(column, row)));
+		memcpy(row_data.data() + column * index_width, &value, index_width);
+	}
+	return row_data.data();
+#endif
+}
+
+void MapFile::set_section(Uint32 tag, const std::vector<Uint8>& data) {
+	sections_[tag] = data;
+}
+
+const std::vector<Uint8>* MapFile::get_section(Uint32 tag) const {
+	std::map<Uint32, std::vector<Uint8>>::const_iterator iter = sections_.find(tag);
+	return iter != sections_.end() ? &iter->second : nullptr;
+}
\ No newline at end of file
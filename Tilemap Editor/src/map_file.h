@@ -0,0 +1,35 @@
+#pragma once
+
+#include <SDL.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tile_grid.h"
+
+struct MapFile {
+	static const Uint16 kVersion = 1;
+
+	MapFile();
+
+	bool load(const std::string& file_path);
+	bool loadLegacyText(const std::string& file_path);
+	bool save(const std::string& file_path) const;
+
+	void set_section(Uint32 tag, const std::vector<Uint8>& data);
+	const std::vector<Uint8>* get_section(Uint32 tag) const;
+
+	void set_tile_grid(const TileGrid& tile_grid) { tile_grid_ = tile_grid; }
+	const TileGrid& get_tile_grid() const { return tile_grid_; }
+	void set_tile_size(int tile_size) { tile_size_ = tile_size; }
+	int get_tile_size() const { return tile_size_; }
+	void set_sheet_name(const std::string& sheet_name) { sheet_name_ = sheet_name; }
+	const std::string& get_sheet_name() const { return sheet_name_; }
+private:
+	const Uint8* rowData(int row, std::vector<Uint8>& row_data) const;
+
+	TileGrid tile_grid_;
+	int tile_size_;
+	std::string sheet_name_;
+	std::map<Uint32, std::vector<Uint8>> sections_;
+};
\ No newline at end of file
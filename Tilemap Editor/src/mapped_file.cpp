@@ -0,0 +1,77 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& file_path) :
+	file_(INVALID_HANDLE_VALUE),
+	mapping_(nullptr),
+	data_(nullptr),
+	size_(0) {
+	file_ = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file_ == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0)
+		return;
+
+	mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping_)
+		return;
+
+	data_ = (const Uint8*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+	if (data_) {
+		size_ = (size_t)size.QuadPart;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		UnmapViewOfFile(data_);
+	}
+	if (mapping_) {
+		CloseHandle(mapping_);
+	}
+	if (file_ != INVALID_HANDLE_VALUE) {
+		CloseHandle(file_);
+	}
+}
+#else
+MappedFile::MappedFile(const std::string& file_path) :
+	file_(-1),
+	data_(nullptr),
+	size_(0) {
+	file_ = open(file_path.c_str(), O_RDONLY);
+	if (file_ < 0)
+		return;
+
+	struct stat status;
+	if (fstat(file_, &status) != 0 || status.st_size == 0)
+		return;
+
+	void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file_, 0);
+	if (data != MAP_FAILED) {
+		data_ = (const Uint8*)data;
+		size_ = (size_t)status.st_size;
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (data_) {
+		munmap((void*)data_, size_);
+	}
+	if (file_ >= 0) {
+		close(file_);
+	}
+}
+#endif
\ No newline at end of file
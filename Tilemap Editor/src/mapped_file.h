@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL.h>
+#include <string>
+
+struct MappedFile {
+	explicit MappedFile(const std::string& file_path);
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool isOpen() const { return data_ != nullptr; }
+	const Uint8* get_data() const { return data_; }
+	size_t get_size() const { return size_; }
+private:
+#ifdef _WIN32
+	void* file_;
+	void* mapping_;
+#else
+	int file_;
+#endif
+	const Uint8* data_;
+	size_t size_;
+};
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "mip_chain.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "chunked_surface.h"
+#include "pixel_pool.h"
+
+namespace {
+	const int kChunkSize = ChunkedSurface::kChunkSize;
+	const int kMaxLevel = 12;
+
+	Uint32 average(Uint32 a, Uint32 b) {
+		return (a & b) + (((a ^ b) & 0xfefefefe) >> 1);
+	}
+}
+
+MipChain::MipChain(std::shared_ptr<PixelPool> pixel_pool, const ChunkedSurface& base) :
+	pixel_pool_(pixel_pool),
+	base_(base) {
+}
+
+MipChain::~MipChain() {
+	reset();
+}
+
+void MipChain::reset() {
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		for (size_t j = 0; j < levels_[i].chunks.size(); ++j) {
+			pixel_pool_->freeSurface(levels_[i].chunks[j]);
+		}
+	}
+	levels_.clear();
+}
+
+void MipChain::invalidate(int x, int y, int width, int height) {
+	if (width <= 0 || height <= 0)
+		return;
+
+	for (size_t i = 0; i < levels_.size(); ++i) {
+		Level& current = levels_[i];
+		const int shift = int(i) + 1;
+		const int first_column = (x >> shift) / kChunkSize;
+		const int last_column = std::min(((x + width - 1) >> shift) / kChunkSize, current.columns - 1);
+		const int first_row = (y >> shift) / kChunkSize;
+		const int last_row = std::min(((y + height - 1) >> shift) / kChunkSize, current.rows - 1);
+		for (int row = first_row; row <= last_row; ++row) {
+			for (int column = first_column; column <= last_column; ++column) {
+				current.built[row * current.columns + column] = false;
+			}
+		}
+	}
+}
+
+int MipChain::levelForScale(float scale) const {
+	if (scale >= 1.0f)
+		return 0;
+	return std::min(int(round(log2(1.0f / scale))), kMaxLevel);
+}
+
+SDL_Surface* MipChain::get_chunk(int index, int column, int row) {
+	if (index == 0)
+		return base_.get_chunk(column, row);
+
+	Level& current = level(index);
+	if (!current.built[row * current.columns + column]) {
+		buildChunk(index, column, row);
+	}
+	return current.chunks[row * current.columns + column];
+}
+
+int MipChain::get_level_width(int index) const {
+	return (base_.get_width() + (1 << index) - 1) >> index;
+}
+
+int MipChain::get_level_height(int index) const {
+	return (base_.get_height() + (1 << index) - 1) >> index;
+}
+
+MipChain::Level& MipChain::level(int index) {
+	while ((int)levels_.size() < index) {
+		const int level_index = (int)levels_.size() + 1;
+		Level next;
+		next.width = get_level_width(level_index);
+		next.height = get_level_height(level_index);
+		next.columns = (next.width + kChunkSize - 1) / kChunkSize;
+		next.rows = (next.height + kChunkSize - 1) / kChunkSize;
+		next.chunks.assign(next.columns * next.rows, nullptr);
+		next.built.assign(next.columns * next.rows, false);
+		levels_.push_back(next);
+	}
+	return levels_[index - 1];
+}
+
+void MipChain::buildChunk(int index, int column, int row) {
+	const int child_columns = index == 1 ? base_.get_columns() : level(index - 1).columns;
+	const int child_rows = index == 1 ? base_.get_rows() : level(index - 1).rows;
+
+	SDL_Surface* children[4] = {};
+	bool uniform = true;
+	for (int i = 0; i < 4; ++i) {
+		const int child_column = column * 2 + (i & 1);
+		const int child_row = row * 2 + (i >> 1);
+		if (child_column < child_columns && child_row < child_rows) {
+			children[i] = get_chunk(index - 1, child_column, child_row);
+		}
+		uniform = uniform && !children[i];
+	}
+
+	Level& current = level(index);
+	SDL_Surface*& chunk = current.chunks[row * current.columns + column];
+	current.built[row * current.columns + column] = true;
+	if (uniform) {
+		pixel_pool_->freeSurface(chunk);
+		chunk = nullptr;
+		return;
+	}
+
+	if (!chunk) {
+		chunk = pixel_pool_->createSurface(kChunkSize, kChunkSize);
+		SDL_SetSurfaceBlendMode(chunk, SDL_BLENDMODE_NONE);
+	}
+	for (int i = 0; i < 4; ++i) {
+		downsampleQuadrant(index, column * 2 + (i & 1), row * 2 + (i >> 1), chunk, (i & 1) * kChunkSize / 2, (i >> 1) * kChunkSize / 2);
+	}
+}
+
+void MipChain::downsampleQuadrant(int index, int child_column, int child_row, SDL_Surface* chunk, int quadrant_x, int quadrant_y) {
+	const int half = kChunkSize / 2;
+	const int child_width = get_level_width(index - 1) - child_column * kChunkSize;
+	const int child_height = get_level_height(index - 1) - child_row * kChunkSize;
+
+	const SDL_Surface* child = nullptr;
+	if (child_width > 0 && child_height > 0) {
+		child = get_chunk(index - 1, child_column, child_row);
+	}
+
+	for (int y = 0; y < half; ++y) {
+		Uint32* destination = (Uint32*)((Uint8*)chunk->pixels_ + (quadrant_y + y) * chunk->pitch) + quadrant_x;
+		if (!child) {
+			std::fill(destination, destination + half, base_.get_fill_pixel());
+			continue;
+		}
+
+		const int top = std::min(y * 2, child_height - 1);
+		const int bottom = std::min(y * 2 + 1, child_height - 1);
+		const Uint32* top_row = (const Uint32*)((const Uint8*)child->pixels_ + top * child->pitch);
+		const Uint32* bottom_row = (const Uint32*)((const Uint8*)child->pixels_ + bottom * child->pitch);
+		for (int x = 0; x < half; ++x) {
+			const int left = std::min(x * 2, child_width - 1);
+			const int right = std::min(x * 2 + 1, child_width - 1);
+			destination[x] = average(average(top_row[left], top_row[right]), average(bottom_row[left], bottom_row[right]));
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+struct ChunkedSurface;
+struct PixelPool;
+
+struct MipChain {
+	MipChain(std::shared_ptr<PixelPool> pixel_pool, const ChunkedSurface& base);
+	~MipChain();
+
+	MipChain(const MipChain&) = delete;
+	MipChain& operator=(const MipChain&) = delete;
+
+	void reset();
+	void invalidate(int x, int y, int width, int height);
+
+	int levelForScale(float scale) const;
+	SDL_Surface* get_chunk(int level, int column, int row);
+	int get_level_width(int level) const;
+	int get_level_height(int level) const;
+private:
+	struct Level {
+		int width, height;
+		int columns, rows;
+		std::vector<SDL_Surface*> chunks;
+		std::vector<bool> built;
+	};
+
+	Level& level(int index);
+	void buildChunk(int index, int column, int row);
+	void downsampleQuadrant(int index, int child_column, int child_row, SDL_Surface* chunk, int quadrant_x, int quadrant_y);
+
+	std::shared_ptr<PixelPool> pixel_pool_;
+	const ChunkedSurface& base_;
+	std::vector<Level> levels_;
+};
\ No newline at end of file
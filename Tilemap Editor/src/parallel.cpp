@@ -0,0 +1,36 @@
+#include "parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+int get_worker_count() {
+	return std::max(1, (int)std::thread::hardware_concurrency());
+}
+
+void parallelFor(int count, const std::function<void(int index)>& body) {
+	const int worker_count = std::min(get_worker_count(), count);
+	if (worker_count <= 1) {
+		for (int i = 0; i < count; ++i) {
+			body(i);
+		}
+		return;
+	}
+
+	std::atomic<int> next_index(0);
+	const auto work = [&]() {
+		for (int i = next_index++; i < count; i = next_index++) {
+			body(i);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < worker_count; ++i) {
+		workers.emplace_back(work);
+	}
+	work();
+	for (size_t i = 0; i < workers.size(); ++i) {
+		workers[i].join();
+	}
+}
\ No newline at end of file
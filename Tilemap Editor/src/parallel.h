@@ -0,0 +1,6 @@
+#pragma once
+
+#include <functional>
+
+int get_worker_count();
+void parallelFor(int count, const std::function<void(int index)>& body);
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include "pixel_pool.h"
+
+#include <algorithm>
+
+namespace {
+	const size_t kMinimumSizeClass = 64 * 64;
+}
+
+PixelPool::PixelPool(size_t budget_bytes) :
+	budget_bytes_(budget_bytes),
+	live_bytes_(0),
+	peak_bytes_(0),
+	pooled_bytes_(0) {
+}
+
+PixelPool::~PixelPool() {
+	trim(0);
+}
+
+Uint32* PixelPool::allocate(size_t pixel_count) {
+	const size_t size_class = sizeClass(pixel_count);
+	const size_t bytes = size_class * sizeof(Uint32);
+
+	Uint32* pixels;
+	std::map<size_t, std::vector<Uint32*>>::iterator iter = free_buffers_.find(size_class);
+	if (iter != free_buffers_.end() && !iter->second.empty()) {
+		pixels = iter->second.back();
+		iter->second.pop_back();
+		pooled_bytes_ -= bytes;
+	} else {
+		pixels = new Uint32[size_class];
+	}
+
+	live_bytes_ += bytes;
+	peak_bytes_ = std::max(peak_bytes_, live_bytes_);
+	return pixels;
+}
+
+void PixelPool::release(Uint32* pixels, size_t pixel_count) {
+	if (!pixels)
+		return;
+
+	const size_t size_class = sizeClass(pixel_count);
+	const size_t bytes = size_class * sizeof(Uint32);
+	live_bytes_ -= bytes;
+
+	if (pooled_bytes_ + bytes > budget_bytes_) {
+		delete[] pixels;
+		return;
+	}
+	free_buffers_[size_class].push_back(pixels);
+	pooled_bytes_ += bytes;
+}
+
+SDL_Surface* PixelPool::createSurface(int width, int height) {
+	Uint32* pixels = allocate(width * height);
+	return SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height, 32, width * sizeof(Uint32), SDL_PIXELFORMAT_BGRA32);
+}
+
+void PixelPool::freeSurface(SDL_Surface* surface) {
+	if (!surface)
+		return;
+	release((Uint32*)surface->pixels_, surface->w * surface->h);
+	SDL_FreeSurface(surface);
+}
+
+void PixelPool::trim(size_t budget_bytes) {
+	for (std::map<size_t, std::vector<Uint32*>>::reverse_iterator iter = free_buffers_.rbegin();
+		iter != free_buffers_.rend() && pooled_bytes_ > budget_bytes;
+		++iter) {
+		while (!iter->second.empty() && pooled_bytes_ > budget_bytes) {
+			delete[] iter->second.back();
+			iter->second.pop_back();
+			pooled_bytes_ -= iter->first * sizeof(Uint32);
+		}
+	}
+}
+
+void PixelPool::set_budget(size_t budget_bytes) {
+	budget_bytes_ = budget_bytes;
+	trim(budget_bytes_);
+}
+
+size_t PixelPool::sizeClass(size_t pixel_count) {
+	size_t size_class = kMinimumSizeClass;
+	while (size_class < pixel_count) {
+		size_class *= 2;
+	}
+	return size_class;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL.h>
+#include <map>
+#include <vector>
+
+struct PixelPool {
+	explicit PixelPool(size_t budget_bytes);
+	~PixelPool();
+
+	PixelPool(const PixelPool&) = delete;
+	PixelPool& operator=(const PixelPool&) = delete;
+
+	Uint32* allocate(size_t pixel_count);
+	void release(Uint32* pixels, size_t pixel_count);
+	SDL_Surface* createSurface(int width, int height);
+	void freeSurface(SDL_Surface* surface);
+	void trim(size_t budget_bytes);
+
+	void set_budget(size_t budget_bytes);
+	size_t get_budget() const { return budget_bytes_; }
+	size_t get_live_bytes() const { return live_bytes_; }
+	size_t get_peak_bytes() const { return peak_bytes_; }
+	size_t get_pooled_bytes() const { return pooled_bytes_; }
+private:
+	static size_t sizeClass(size_t pixel_count);
+
+	std::map<size_t, std::vector<Uint32*>> free_buffers_;
+	size_t budget_bytes_;
+	size_t live_bytes_;
+	size_t peak_bytes_;
+	size_t pooled_bytes_;
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "pixel_scaler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define PIXEL_SCALER_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_SCALER_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#else
+#define PIXEL_SCALER_TARGET(instruction_set)
+#endif
+
+namespace {
+	void scaleRowScalar(const Uint32* source, int factor, int skip, Uint32* destination, int width) {
+		int repeat = factor - skip;
+		for (int x = 0; x < width;) {
+			const Uint32 pixel = *source++;
+			const int count = std::min(repeat, width - x);
+			for (int i = 0; i < count; ++i) {
+				destination[x + i] = pixel;
+			}
+			x += count;
+			repeat = factor;
+		}
+	}
+
+#ifdef PIXEL_SCALER_X86
+	PIXEL_SCALER_TARGET("sse2")
+	void scaleRowSse2(const Uint32* source, int factor, int skip, Uint32* destination, int width) {
+		int x = 0;
+		if (skip > 0) {
+			x = std::min(factor - skip, width);
+			std::fill(destination, destination + x, *source++);
+		}
+
+		if (factor == 2) {
+			for (; x + 8 <= width; x += 8, source += 4) {
+				const __m128i pixels = _mm_loadu_si128((const __m128i*)source);
+				_mm_storeu_si128((__m128i*)(destination + x), _mm_unpacklo_epi32(pixels, pixels));
+				_mm_storeu_si128((__m128i*)(destination + x + 4), _mm_unpackhi_epi32(pixels, pixels));
+			}
+		} else {
+			const int stored = (factor + 3) & ~3;
+			for (; x + stored <= width; x += factor, ++source) {
+				const __m128i pixel = _mm_set1_epi32((int)*source);
+				for (int i = 0; i < factor; i += 4) {
+					_mm_storeu_si128((__m128i*)(destination + x + i), pixel);
+				}
+			}
+		}
+		scaleRowScalar(source, factor, 0, destination + x, width - x);
+	}
+
+	PIXEL_SCALER_TARGET("avx2")
+	void scaleRowAvx2(const Uint32* source, int factor, int skip, Uint32* destination, int width) {
+		int x = 0;
+		if (skip > 0) {
+			x = std::min(factor - skip, width);
+			std::fill(destination, destination + x, *source++);
+		}
+
+		if (factor == 2) {
+			const __m256i indices = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+			for (; x + 8 <= width; x += 8, source += 4) {
+				const __m256i pixels = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)source));
+				_mm256_storeu_si256((__m256i*)(destination + x), _mm256_permutevar8x32_epi32(pixels, indices));
+			}
+		} else if (factor == 4) {
+			const __m256i indices = _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1);
+			for (; x + 8 <= width; x += 8, source += 2) {
+				const __m256i pixels = _mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)source));
+				_mm256_storeu_si256((__m256i*)(destination + x), _mm256_permutevar8x32_epi32(pixels, indices));
+			}
+		} else {
+			const int stored = (factor + 7) & ~7;
+			for (; x + stored <= width; x += factor, ++source) {
+				const __m256i pixel = _mm256_set1_epi32((int)*source);
+				for (int i = 0; i < factor; i += 8) {
+					_mm256_storeu_si256((__m256i*)(destination + x + i), pixel);
+				}
+			}
+		}
+		scaleRowScalar(source, factor, 0, destination + x, width - x);
+	}
+#endif
+}
+
+PixelScaler::PixelScaler() :
+	row_scaler_(scaleRowScalar),
+	name_("scalar") {
+#ifdef PIXEL_SCALER_X86
+	if (SDL_HasAVX2()) {
+		row_scaler_ = scaleRowAvx2;
+		name_ = "AVX2";
+	} else if (SDL_HasSSE2()) {
+		row_scaler_ = scaleRowSse2;
+		name_ = "SSE2";
+	}
+#endif
+}
+
+bool PixelScaler::canScale(SDL_Surface* source, const SDL_Surface* destination) const {
+	SDL_BlendMode blend_mode;
+	SDL_GetSurfaceBlendMode(source, &blend_mode);
+	return source->format->format == SDL_PIXELFORMAT_BGRA32 &&
+		blend_mode == SDL_BLENDMODE_NONE &&
+		!SDL_HasColorKey(source) &&
+		destination->format->BytesPerPixel == 4 &&
+		destination->format->Rmask == 0x00ff0000 &&
+		destination->format->Gmask == 0x0000ff00 &&
+		destination->format->Bmask == 0x000000ff;
+}
+
+void PixelScaler::scaleInteger(const SDL_Surface* source, const SDL_Rect& source_rectangle, int factor_x, int factor_y, SDL_Surface* destination, int x, int y) const {
+	const SDL_Rect target_rectangle = { x, y, source_rectangle.w * factor_x, source_rectangle.h * factor_y };
+	SDL_Rect clipped_rectangle;
+	if (!SDL_IntersectRect(&target_rectangle, &destination->clip_rect, &clipped_rectangle))
+		return;
+
+	const int skip_x = (clipped_rectangle.x - x) % factor_x;
+	const int source_x = source_rectangle.x + (clipped_rectangle.x - x) / factor_x;
+	const int bottom = clipped_rectangle.y + clipped_rectangle.h;
+	for (int row = clipped_rectangle.y; row < bottom;) {
+		const int source_y = source_rectangle.y + (row - y) / factor_y;
+		const int repeat = std::min(factor_y - (row - y) % factor_y, bottom - row);
+
+		const Uint32* source_row = (const Uint32*)((const Uint8*)source->pixels_ + source_y * source->pitch) + source_x;
+		Uint8* destination_row = (Uint8*)destination->pixels_ + row * destination->pitch + clipped_rectangle.x * sizeof(Uint32);
+		row_scaler_(source_row, factor_x, skip_x, (Uint32*)destination_row, clipped_rectangle.w);
+		for (int i = 1; i < repeat; ++i) {
+			memcpy(destination_row + i * destination->pitch, destination_row, clipped_rectangle.w * sizeof(Uint32));
+		}
+		row += repeat;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <SDL.h>
+
+struct PixelScaler {
+	PixelScaler();
+
+	bool canScale(SDL_Surface* source, const SDL_Surface* destination) const;
+	void scaleInteger(const SDL_Surface* source, const SDL_Rect& source_rectangle, int factor_x, int factor_y, SDL_Surface* destination, int x, int y) const;
+
+	const char* get_name() const { return name_; }
+private:
+	typedef void (*RowScaler)(const Uint32* source, int factor, int skip, Uint32* destination, int width);
+
+	RowScaler row_scaler_;
+	const char* name_;
+};
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "save_worker.h"
+
+#include <cstdio>
+
+#include "bmp_writer.h"
+#include "chunked_surface.h"
+#include "collision_boxes.h"
+#include "collision_masks.h"
+#include "collision_outlines.h"
+#include "collision_profile.h"
+#include "map_file.h"
+#include "tile_map_renderer.h"
+
+namespace {
+	const float kBitmapProgress = 0.9f;
+	const float kOutlineTolerance = 1.0f;
+}
+
+SaveWorker::SaveWorker() :
+	status_(IDLE),
+	superseded_(0),
+	stopping_(false),
+	progress_(0.0f),
+	collision_boxes_(-1),
+	solid_cells_(-1),
+	collision_polygons_(-1),
+	collision_points_(-1),
+	thread_(&SaveWorker::run, this) {
+}
+
+SaveWorker::~SaveWorker() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stopping_ = true;
+	}
+	condition_.notify_one();
+	thread_.join();
+}
+
+void SaveWorker::submit(std::unique_ptr<SaveJob> job) {
+	std::unique_ptr<SaveJob> superseded_job;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		for (size_t i = 0; i < pending_.size(); ++i) {
+			if (pending_[i]->file_path == job->file_path) {
+				job->obsolete_files.insert(job->obsolete_files.end(),
+					pending_[i]->obsolete_files.begin(), pending_[i]->obsolete_files.end());
+				superseded_job.swap(pending_[i]);
+				pending_[i].swap(job);
+				++superseded_;
+				break;
+			}
+		}
+		if (job) {
+			pending_.push_back(std::move(job));
+		}
+	}
+	condition_.notify_one();
+}
+
+void SaveWorker::collect() {
+	std::vector<std::unique_ptr<SaveJob>> finished;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		finished.swap(finished_);
+	}
+}
+
+bool SaveWorker::isBusy() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return status_ == SAVING || !pending_.empty();
+}
+
+SaveWorker::Status SaveWorker::get_status() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return status_;
+}
+
+std::string SaveWorker::get_message() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return message_;
+}
+
+void SaveWorker::run() {
+	std::unique_lock<std::mutex> lock(mutex_);
+	while (true) {
+		condition_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+		if (pending_.empty())
+			return;
+
+		std::unique_ptr<SaveJob> job = std::move(pending_.front());
+		pending_.pop_front();
+		status_ = SAVING;
+		message_ = "Saving " + job->file_path;
+		progress_ = 0.0f;
+		lock.unlock();
+
+		const bool saved = save(*job);
+		if (saved) {
+			for (size_t i = 0; i < job->obsolete_files.size(); ++i) {
+				std::remove(job->obsolete_files[i].c_str());
+			}
+		}
+
+		lock.lock();
+		status_ = saved ? SUCCEEDED : FAILED;
+		message_ = (saved ? "Saved " : "Failed to save ") + job->file_path;
+		progress_ = 1.0f;
+		finished_.push_back(std::move(job));
+	}
+}
+
+bool SaveWorker::save(const SaveJob& job) {
+	switch (job.kind) {
+	case SaveJob::TILE_SHEET:
+		return saveBitmap(*job.pixels, job.file_path + ".bmp", kBitmapProgress) && saveProfile(job) && saveCollisionMasks(job);
+	case SaveJob::TILE_MAP:
+		return saveTileBitmap(job, kBitmapProgress) && saveMap(job);
+	case SaveJob::MAP_FILE:
+		return saveMap(job);
+	default:
+		return saveBitmap(*job.pixels, job.file_path + ".bmp", kBitmapProgress) && saveMap(job);
+	}
+}
+
+bool SaveWorker::saveBitmap(const ChunkedSurface& pixels, const std::string& file_path, float progress_end) {
+	const int width = pixels.get_width();
+	const int height = pixels.get_height();
+	BmpWriter writer(file_path, width, height);
+	if (!writer.isOpen())
+		return false;
+
+	std::vector<Uint32> row(width);
+	for (int y = 0; y < height; ++y) {
+		pixels.readRow(0, y, width, row.data());
+		writer.writeRow(row.data());
+		progress_ = progress_end * (y + 1) / height;
+	}
+	return writer.close();
+}
+
+bool SaveWorker::saveTileBitmap(const SaveJob& job, float progress_end) {
+	const int rows = job.tile_grid.get_rows();
+	const int columns = job.tile_grid.get_columns();
+	const int width = columns * job.tile_size;
+	BmpWriter writer(job.file_path + ".bmp", width, rows * job.tile_size);
+	if (!writer.isOpen())
+		return false;
+
+	std::vector<Uint32> strip(size_t(width) * job.tile_size);
+	for (int row = 0; row < rows; ++row) {
+		for (int column = 0; column < columns; ++column) {
+			TileMapRenderer::copyTile(*job.pixels, job.tile_grid.get(column, row), job.tile_size, strip.data() + column * job.tile_size, width);
+		}
+		for (int y = 0; y < job.tile_size; ++y) {
+			writer.writeRow(strip.data() + size_t(y) * width);
+		}
+		progress_ = progress_end * (row + 1) / rows;
+	}
+	return writer.close();
+}
+
+bool SaveWorker::saveProfile(const SaveJob& job) {
+	CollisionProfile collision_profile(*job.pixels, job.tile_size);
+	return collision_profile.save(job.file_path + ".txt");
+}
+
+bool SaveWorker::saveCollisionMasks(const SaveJob& job) {
+	CollisionMasks collision_masks(*job.pixels, job.tile_size, job.distance_field_size);
+	return collision_masks.save(job.file_path + ".col");
+}
+
+bool SaveWorker::saveMap(const SaveJob& job) {
+	MapFile map_file;
+	map_file.set_tile_grid(job.tile_grid);
+	map_file.set_tile_size(job.tile_size);
+	map_file.set_sheet_name(job.sheet_name);
+
+	const bool has_sheet = job.kind == SaveJob::TILE_MAP || job.kind == SaveJob::MAP_FILE;
+	if (has_sheet) {
+		CollisionProfile collision_profile(*job.pixels, job.tile_size);
+		CollisionBoxes collision_boxes(job.tile_grid, CollisionBoxes::solidTiles(collision_profile));
+		map_file.set_section(CollisionBoxes::kSectionTag, collision_boxes.serialize());
+		collision_boxes_ = (int)collision_boxes.get_boxes().size();
+		solid_cells_ = collision_boxes.get_solid_cells();
+
+		CollisionMasks collision_masks(*job.pixels, job.tile_size, 0);
+		CollisionOutlines collision_outlines(collision_masks, job.tile_grid, kOutlineTolerance);
+		map_file.set_section(CollisionOutlines::kSectionTag, collision_outlines.serialize());
+		collision_polygons_ = (int)collision_outlines.get_polygons().size();
+		collision_points_ = (int)collision_outlines.get_point_count();
+	}
+	return map_file.save(job.file_path + ".map");
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tile_grid.h"
+
+struct ChunkedSurface;
+
+struct SaveJob {
+	enum Kind {
+		TILE_SHEET,
+		TILE_MAP,
+		BAKED_TILE_MAP,
+		MAP_FILE
+	};
+
+	Kind kind;
+	std::string file_path;
+	std::shared_ptr<const ChunkedSurface> pixels;
+	TileGrid tile_grid;
+	int tile_size;
+	int distance_field_size;
+	std::string sheet_name;
+	std::vector<std::string> obsolete_files;
+};
+
+struct SaveWorker {
+	enum Status {
+		IDLE,
+		SAVING,
+		SUCCEEDED,
+		FAILED
+	};
+
+	SaveWorker();
+	~SaveWorker();
+
+	SaveWorker(const SaveWorker&) = delete;
+	SaveWorker& operator=(const SaveWorker&) = delete;
+
+	void submit(std::unique_ptr<SaveJob> job);
+	void collect();
+
+	bool isBusy() const;
+	Status get_status() const;
+	std::string get_message() const;
+	float get_progress() const { return progress_; }
+	int get_superseded() const { return superseded_; }
+	int get_collision_boxes() const { return collision_boxes_; }
+	int get_solid_cells() const { return solid_cells_; }
+	int get_collision_polygons() const { return collision_polygons_; }
+	int get_collision_points() const { return collision_points_; }
+private:
+	void run();
+	bool save(const SaveJob& job);
+	bool saveBitmap(const ChunkedSurface& pixels, const std::string& file_path, float progress_end);
+	bool saveTileBitmap(const SaveJob& job, float progress_end);
+	bool saveProfile(const SaveJob& job);
+	bool saveCollisionMasks(const SaveJob& job);
+	bool saveMap(const SaveJob& job);
+
+	mutable std::mutex mutex_;
+	std::condition_variable condition_;
+	std::deque<std::unique_ptr<SaveJob>> pending_;
+	std::vector<std::unique_ptr<SaveJob>> finished_;
+	Status status_;
+	std::string message_;
+	int superseded_;
+	bool stopping_;
+	std::atomic<float> progress_;
+	std::atomic<int> collision_boxes_;
+	std::atomic<int> solid_cells_;
+	std::atomic<int> collision_polygons_;
+	std::atomic<int> collision_points_;
+	std::thread thread_;
+};
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include "solidity_masker.h"
+
+#include <algorithm>
+
+#include "chunked_surface.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SOLIDITY_MASKER_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SOLIDITY_MASKER_TARGET(instruction_set) __attribute__((target(instruction_set)))
+#else
+#define SOLIDITY_MASKER_TARGET(instruction_set)
+#endif
+
+namespace {
+	const Uint32 kColorMask = 0x00ffffff;
+
+	Uint64 maskRowScalar(const Uint32* pixels, int count) {
+		Uint64 mask = 0;
+		for (int i = 0; i < count; ++i) {
+			if ((pixels[i] & kColorMask) != 0) {
+				mask |= Uint64(1) << i;
+			}
+		}
+		return mask;
+	}
+
+#ifdef SOLIDITY_MASKER_X86
+	SOLIDITY_MASKER_TARGET("sse2")
+	Uint64 maskRowSse2(const Uint32* pixels, int count) {
+		const __m128i color_mask = _mm_set1_epi32((int)kColorMask);
+		const __m128i zero = _mm_setzero_si128();
+		Uint64 mask = 0;
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			const __m128i black = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i*)(pixels + i)), color_mask), zero);
+			mask |= Uint64(_mm_movemask_ps(_mm_castsi128_ps(black)) ^ 0xf) << i;
+		}
+		return i < count ? mask | (maskRowScalar(pixels + i, count - i) << i) : mask;
+	}
+
+	SOLIDITY_MASKER_TARGET("avx2")
+	Uint64 maskRowAvx2(const Uint32* pixels, int count) {
+		const __m256i color_mask = _mm256_set1_epi32((int)kColorMask);
+		const __m256i zero = _mm256_setzero_si256();
+		Uint64 mask = 0;
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			const __m256i black = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_loadu_si256((const __m256i*)(pixels + i)), color_mask), zero);
+			mask |= Uint64(_mm256_movemask_ps(_mm256_castsi256_ps(black)) ^ 0xff) << i;
+		}
+		return i < count ? mask | (maskRowScalar(pixels + i, count - i) << i) : mask;
+	}
+#endif
+}
+
+SolidityMasker::SolidityMasker() :
+	row_masker_(maskRowScalar),
+	name_("scalar") {
+#ifdef SOLIDITY_MASKER_X86
+	if (SDL_HasAVX2()) {
+		row_masker_ = maskRowAvx2;
+		name_ = "AVX2";
+	} else if (SDL_HasSSE2()) {
+		row_masker_ = maskRowSse2;
+		name_ = "SSE2";
+	}
+#endif
+}
+
+void SolidityMasker::maskRow(const ChunkedSurface& pixels, int y, std::vector<Uint64>& words) const {
+	const int width = pixels.get_width();
+	words.assign((width + kWordBits - 1) / kWordBits, 0);
+	for (int x = 0; x < width;) {
+		int length;
+		const Uint32* span = pixels.pixelSpan(x, y, length);
+		length = std::min(std::min(length, width - x), kWordBits - x % kWordBits);
+		words[x / kWordBits] |= row_masker_(span, length) << (x % kWordBits);
+		x += length;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+struct ChunkedSurface;
+
+struct SolidityMasker {
+	static constexpr int kWordBits = 64;
+
+	SolidityMasker();
+
+	Uint64 mask(const Uint32* pixels, int count) const { return row_masker_(pixels, count); }
+	void maskRow(const ChunkedSurface& pixels, int y, std::vector<Uint64>& words) const;
+
+	const char* get_name() const { return name_; }
+private:
+	typedef Uint64 (*RowMasker)(const Uint32* pixels, int count);
+
+	RowMasker row_masker_;
+	const char* name_;
+};
\ No newline at end of file
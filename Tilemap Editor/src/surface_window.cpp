@@ -1,10 +1,15 @@
 #include "surface_window.h"
 
+#include "pixel_pool.h"
+
 namespace {
     const Uint32 kClearColor = (51 << 16) | (102 << 8) | 153;
+    const size_t kMaxDirtyRectangles = 32;
 }
 
-SurfaceWindow::SurfaceWindow(int width, int height, Uint32 flags) {
+SurfaceWindow::SurfaceWindow(int width, int height, Uint32 flags, std::shared_ptr<PixelPool> pixel_pool) :
+    pixel_pool_(pixel_pool),
+    fully_dirty_(true) {
     window_ = SDL_CreateWindow("Canvas", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, width, height, flags);
     screen_ = SDL_GetWindowSurface(window_);
 }
@@ -15,9 +20,6 @@ SurfaceWindow::~SurfaceWindow() {
         ++iter) {
         SDL_FreeSurface(iter->second);
     }
-    for (size_t i = 0; i < pixels_.size(); ++i) {
-        delete[] pixels_[i];
-    }
     SDL_FreeSurface(screen_);
     SDL_DestroyWindow(window_);
 }
@@ -35,38 +37,84 @@ SDL_Surface* SurfaceWindow::loadImage(const std::string& file_name, bool black_i
     return sprite_sheets_[file_path];
 }
 
+SDL_Surface* SurfaceWindow::loadUncachedImage(const std::string& file_name) {
+    return SDL_LoadBMP((file_name + ".bmp").c_str());
+}
+
 SDL_Surface* SurfaceWindow::createSurface(int width, int height) {
-    Uint32* pixels = new Uint32[width * height];
-    memset(pixels, 255, width * height * sizeof(Uint32));
-    pixels_.push_back(pixels);
-    return SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height, 32, 4*width, SDL_PIXELFORMAT_BGRA32);
+    SDL_Surface* surface = pixel_pool_->createSurface(width, height);
+    memset(surface->pixels_, 255, width * height * sizeof(Uint32));
+    return surface;
 }
 
-void SurfaceWindow::saveSurface(SDL_Surface* surface, const std::string& file_path) {
-    SDL_SaveBMP(surface, file_path.c_str());
+void SurfaceWindow::freeSurface(SDL_Surface* surface) {
+    pixel_pool_->freeSurface(surface);
 }
 
-SDL_Surface* SurfaceWindow::changeSurfaceSize(SDL_Surface* surface, int x, int y) {
-    const int width = surface->w + x;
-    const int height = surface->h + y;
-    Uint32* pixels = new Uint32[width * height];
-    memset(pixels, 255, width * height * sizeof(Uint32));
-    pixels_.push_back(pixels);
-    SDL_Surface* changed_surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height, 32, 4 * width, SDL_PIXELFORMAT_BGRA32);
-    SDL_BlitSurface(surface, NULL, changed_surface, NULL);
-    return changed_surface;
+void SurfaceWindow::saveSurface(SDL_Surface* surface, const std::string& file_path) {
+    SDL_SaveBMP(surface, file_path.c_str());
 }
 
 void SurfaceWindow::blitSurface(SDL_Surface* source, SDL_Rect* source_rectangle, SDL_Rect* destination_rectangle, bool use_autocorrention) {
     SDL_BlitScaled(source, source_rectangle, screen_, destination_rectangle);
 }
 
+void SurfaceWindow::blitSurfaceInteger(SDL_Surface* source, const SDL_Rect& source_rectangle, int x, int y, int factor_x, int factor_y) {
+    if (pixel_scaler_.canScale(source, screen_)) {
+        pixel_scaler_.scaleInteger(source, source_rectangle, factor_x, factor_y, screen_, x, y);
+    } else {
+        SDL_Rect scaled_source_rectangle = source_rectangle;
+        SDL_Rect destination_rectangle = { x, y, source_rectangle.w * factor_x, source_rectangle.h * factor_y };
+        SDL_BlitScaled(source, &scaled_source_rectangle, screen_, &destination_rectangle);
+    }
+}
+
 void SurfaceWindow::clear() {
+    SDL_Rect clip_rectangle = { 0, 0, 0, 0 };
+    if (fully_dirty_) {
+        clip_rectangle.w = screen_->w;
+        clip_rectangle.h = screen_->h;
+    } else if (!dirty_rectangles_.empty()) {
+        clip_rectangle = dirty_rectangles_[0];
+        for (size_t i = 1; i < dirty_rectangles_.size(); ++i) {
+            SDL_UnionRect(&clip_rectangle, &dirty_rectangles_[i], &clip_rectangle);
+        }
+    }
+    SDL_SetClipRect(screen_, &clip_rectangle);
     SDL_FillRect(screen_, NULL, kClearColor);
 }
 
 void SurfaceWindow::flip() {
-    SDL_UpdateWindowSurface(window_);
+    if (fully_dirty_) {
+        SDL_UpdateWindowSurface(window_);
+    } else if (!dirty_rectangles_.empty()) {
+        SDL_UpdateWindowSurfaceRects(window_, dirty_rectangles_.data(), (int)dirty_rectangles_.size());
+    }
+    dirty_rectangles_.clear();
+    fully_dirty_ = false;
+}
+
+void SurfaceWindow::invalidate() {
+    fully_dirty_ = true;
+    dirty_rectangles_.clear();
+}
+
+void SurfaceWindow::invalidate(const SDL_Rect& rectangle) {
+    if (fully_dirty_)
+        return;
+
+    const SDL_Rect screen_rectangle = { 0, 0, screen_->w, screen_->h };
+    SDL_Rect clipped_rectangle;
+    if (!SDL_IntersectRect(&rectangle, &screen_rectangle, &clipped_rectangle))
+        return;
+
+    if (dirty_rectangles_.size() == kMaxDirtyRectangles) {
+        for (size_t i = 1; i < dirty_rectangles_.size(); ++i) {
+            SDL_UnionRect(&dirty_rectangles_[0], &dirty_rectangles_[i], &dirty_rectangles_[0]);
+        }
+        dirty_rectangles_.resize(1);
+    }
+    dirty_rectangles_.push_back(clipped_rectangle);
 }
 
 void SurfaceWindow::drawRect(const Rectangle& rectangle, Uint32 border_color, Uint32 fill_color) {
@@ -101,6 +149,16 @@ void SurfaceWindow::drawLine(int x1, int y1, int x2, int y2, Uint32 color) {
     SDL_FillRect(screen_, &rectangle, color);
 }
 
+void SurfaceWindow::fillRect(const SDL_Rect& rectangle, Uint32 color) {
+    SDL_FillRect(screen_, &rectangle, color);
+}
+
+void SurfaceWindow::fillRects(const std::vector<SDL_Rect>& rectangles, Uint32 color) {
+    if (!rectangles.empty()) {
+        SDL_FillRects(screen_, rectangles.data(), (int)rectangles.size(), color);
+    }
+}
+
 void SurfaceWindow::get_window_position(int& x, int& y) const {
     SDL_GetWindowPosition(window_, &x, &y);
 }
@@ -109,6 +167,12 @@ void SurfaceWindow::get_window_size(int& x, int& y) const {
     SDL_GetWindowSize(window_, &x, &y);
 }
 
+SDL_Rect SurfaceWindow::get_clip_rectangle() const {
+    SDL_Rect clip_rectangle;
+    SDL_GetClipRect(screen_, &clip_rectangle);
+    return clip_rectangle;
+}
+
 Uint32 SurfaceWindow::get_window_id() const {
     return SDL_GetWindowID(window_);
 }
@@ -6,39 +6,53 @@
 #include <memory>
 #include <vector>
 
+#include "pixel_scaler.h"
 #include "rectangle.h" // __DEBUG__
 
+struct PixelPool;
 struct SDL_Window;
 struct SDL_Renderer;
 struct SDL_Surface;
 struct SDL_Rect;
 
 struct SurfaceWindow {
-	SurfaceWindow(int width, int height, Uint32 flags);
+	SurfaceWindow(int width, int height, Uint32 flags, std::shared_ptr<PixelPool> pixel_pool);
 	~SurfaceWindow();
 
 
 	SDL_Surface* loadImage(const std::string& file_name, bool black_is_transparent);
+	SDL_Surface* loadUncachedImage(const std::string& file_name);
 	SDL_Surface* createSurface(int width, int height);
+	void freeSurface(SDL_Surface* surface);
 	void saveSurface(SDL_Surface* surface, const std::string& file_path);
 
-	SDL_Surface* changeSurfaceSize(SDL_Surface* surface, int x, int y);
-
 	void blitSurface(SDL_Surface* source, SDL_Rect* source_rectangle, SDL_Rect* destination_rectangle, bool use_autocorrection);
+	void blitSurfaceInteger(SDL_Surface* source, const SDL_Rect& source_rectangle, int x, int y, int factor_x, int factor_y);
 	void clear();
 	void flip();
 
+	void invalidate();
+	void invalidate(const SDL_Rect& rectangle);
+	bool isDirty() const { return fully_dirty_ || !dirty_rectangles_.empty(); }
+
 	void drawRect(const Rectangle& rectangle, Uint32 border_color, Uint32 fill_color);
 	void drawLine(int x1, int y1, int x2, int y2, Uint32 color);
+	void fillRect(const SDL_Rect& rectangle, Uint32 color);
+	void fillRects(const std::vector<SDL_Rect>& rectangles, Uint32 color);
 
 	void get_window_position(int& x, int& y) const;
 	void get_window_size(int& x, int& y) const;
 	Uint32 get_window_id() const;
+	SDL_Rect get_clip_rectangle() const;
+	std::shared_ptr<PixelPool> get_pixel_pool() const { return pixel_pool_; }
 	void set_position(int x, int y);
 	void raise();
 private:
 	std::map<std::string, SDL_Surface*> sprite_sheets_;
-	std::vector<Uint32*> pixels_;
+	std::shared_ptr<PixelPool> pixel_pool_;
+	PixelScaler pixel_scaler_;
+	std::vector<SDL_Rect> dirty_rectangles_;
+	bool fully_dirty_;
 
 	SDL_Window* window_;
 	SDL_Surface* screen_;
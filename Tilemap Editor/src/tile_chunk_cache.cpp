@@ -0,0 +1,86 @@
+#include "tile_chunk_cache.h"
+
+#include "pixel_pool.h"
+
+TileChunkCache::TileChunkCache(std::shared_ptr<PixelPool> pixel_pool, size_t budget_bytes) :
+	pixel_pool_(pixel_pool),
+	budget_bytes_(budget_bytes),
+	bytes_(0),
+	hits_(0),
+	misses_(0) {
+}
+
+TileChunkCache::~TileChunkCache() {
+	clear();
+}
+
+SDL_Surface* TileChunkCache::find(int band, int column, int row) {
+	std::unordered_map<Key, Entry>::iterator iter = entries_.find(makeKey(band, column, row));
+	if (iter == entries_.end()) {
+		++misses_;
+		return nullptr;
+	}
+
+	++hits_;
+	recently_used_.splice(recently_used_.begin(), recently_used_, iter->second.position);
+	return iter->second.surface;
+}
+
+SDL_Surface* TileChunkCache::insert(int band, int column, int row, int width, int height) {
+	const Key key = makeKey(band, column, row);
+	std::unordered_map<Key, Entry>::iterator iter = entries_.find(key);
+	if (iter != entries_.end()) {
+		erase(iter);
+	}
+
+	const size_t bytes = size_t(width) * height * sizeof(Uint32);
+	evict(budget_bytes_ > bytes ? budget_bytes_ - bytes : 0);
+
+	Entry entry;
+	entry.surface = pixel_pool_->createSurface(width, height);
+	SDL_SetSurfaceBlendMode(entry.surface, SDL_BLENDMODE_NONE);
+	recently_used_.push_front(key);
+	entry.position = recently_used_.begin();
+	entries_[key] = entry;
+	bytes_ += bytes;
+	return entry.surface;
+}
+
+void TileChunkCache::invalidate(int column, int row) {
+	for (int band = 0; band <= kMaxBand; ++band) {
+		std::unordered_map<Key, Entry>::iterator iter = entries_.find(makeKey(band, column, row));
+		if (iter != entries_.end()) {
+			erase(iter);
+		}
+	}
+}
+
+void TileChunkCache::clear() {
+	evict(0);
+}
+
+void TileChunkCache::set_budget(size_t budget_bytes) {
+	budget_bytes_ = budget_bytes;
+	evict(budget_bytes_);
+}
+
+TileChunkCache::Key TileChunkCache::makeKey(int band, int column, int row) {
+	return (Key(band) << 56) | (Key(row) << 28) | Key(column);
+}
+
+size_t TileChunkCache::surfaceBytes(const SDL_Surface* surface) {
+	return size_t(surface->w) * surface->h * sizeof(Uint32);
+}
+
+void TileChunkCache::erase(std::unordered_map<Key, Entry>::iterator iter) {
+	bytes_ -= surfaceBytes(iter->second.surface);
+	pixel_pool_->freeSurface(iter->second.surface);
+	recently_used_.erase(iter->second.position);
+	entries_.erase(iter);
+}
+
+void TileChunkCache::evict(size_t budget_bytes) {
+	while (bytes_ > budget_bytes && !recently_used_.empty()) {
+		erase(entries_.find(recently_used_.back()));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SDL.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+struct PixelPool;
+
+struct TileChunkCache {
+	static constexpr int kMaxBand = 15;
+
+	TileChunkCache(std::shared_ptr<PixelPool> pixel_pool, size_t budget_bytes);
+	~TileChunkCache();
+
+	TileChunkCache(const TileChunkCache&) = delete;
+	TileChunkCache& operator=(const TileChunkCache&) = delete;
+
+	SDL_Surface* find(int band, int column, int row);
+	SDL_Surface* insert(int band, int column, int row, int width, int height);
+	void invalidate(int column, int row);
+	void clear();
+
+	void set_budget(size_t budget_bytes);
+	size_t get_budget() const { return budget_bytes_; }
+	size_t get_bytes() const { return bytes_; }
+	size_t get_entries() const { return entries_.size(); }
+	Uint64 get_hits() const { return hits_; }
+	Uint64 get_misses() const { return misses_; }
+private:
+	typedef Uint64 Key;
+	struct Entry {
+		SDL_Surface* surface;
+		std::list<Key>::iterator position;
+	};
+
+	static Key makeKey(int band, int column, int row);
+	static size_t surfaceBytes(const SDL_Surface* surface);
+	void erase(std::unordered_map<Key, Entry>::iterator iter);
+	void evict(size_t budget_bytes);
+
+	std::shared_ptr<PixelPool> pixel_pool_;
+	std::unordered_map<Key, Entry> entries_;
+	std::list<Key> recently_used_;
+	size_t budget_bytes_;
+	size_t bytes_;
+	Uint64 hits_;
+	Uint64 misses_;
+};
\ No newline at end of file
@@ -0,0 +1,200 @@
+#include "tile_duplicates.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "chunked_surface.h"
+#include "parallel.h"
+#include "tile_table.h"
+
+namespace {
+	const int kHashColumns = 9;
+	const int kHashRows = 8;
+	const int kHashBits = 64;
+	const int kMaxAverageDifference = 16;
+
+	int findRoot(std::vector<int>& parents, int tile) {
+		while (parents[tile] != tile) {
+			parents[tile] = parents[parents[tile]];
+			tile = parents[tile];
+		}
+		return tile;
+	}
+
+	int hashDistance(Uint64 a, Uint64 b) {
+		return (int)std::bitset<kHashBits>(a ^ b).count();
+	}
+
+	Uint32 averagePixel(const Uint32* pixels, int count) {
+		Uint64 sums[4] = {};
+		for (int i = 0; i < count; ++i) {
+			for (int channel = 0; channel < 4; ++channel) {
+				sums[channel] += (pixels[i] >> (channel * 8)) & 0xff;
+			}
+		}
+		Uint32 average = 0;
+		for (int channel = 0; channel < 4; ++channel) {
+			average |= Uint32(sums[channel] / count) << (channel * 8);
+		}
+		return average;
+	}
+
+	bool similarAverages(Uint32 a, Uint32 b) {
+		for (int channel = 0; channel < 4; ++channel) {
+			if (std::abs(int((a >> (channel * 8)) & 0xff) - int((b >> (channel * 8)) & 0xff)) > kMaxAverageDifference)
+				return false;
+		}
+		return true;
+	}
+
+	int luminance(Uint32 pixel) {
+		return int((pixel >> 16) & 0xff) * 299 + int((pixel >> 8) & 0xff) * 587 + int(pixel & 0xff) * 114;
+	}
+}
+
+TileDuplicates::TileDuplicates(const ChunkedSurface& sheet, int tile_size, int max_distance) :
+	tile_count_(0) {
+	TileTable tile_table(sheet, tile_size);
+	tile_count_ = tile_table.get_tile_count();
+
+	std::vector<Uint32> entries(tile_count_);
+	std::vector<Uint64> hashes(tile_count_);
+	std::vector<Uint32> averages(tile_count_);
+	parallelFor(tile_table.get_rows(), [&](int row) {
+		std::vector<Uint32> tile_pixels(size_t(tile_size) * tile_size);
+		for (int column = 0; column < tile_table.get_columns(); ++column) {
+			const int tile = row * tile_table.get_columns() + column;
+			entries[tile] = tile_table.insert(tile, tile_table.readTile(tile, tile_pixels.data()), tile_pixels.data());
+			hashes[tile] = perceptualHash(tile_pixels.data(), tile_size);
+			averages[tile] = averagePixel(tile_pixels.data(), tile_size * tile_size);
+		}
+	});
+
+	std::vector<int> exact_firsts(tile_count_);
+	std::vector<int> representatives;
+	for (int tile = 0; tile < tile_count_; ++tile) {
+		exact_firsts[tile] = tile_table.get_first(entries[tile]);
+		if (exact_firsts[tile] == tile) {
+			representatives.push_back(tile);
+		}
+	}
+	std::vector<int> parents(exact_firsts);
+
+	max_distance = std::min(max_distance, kMaxDistance);
+	if (max_distance >= 0) {
+		const int bands = max_distance + 1;
+		std::vector<std::unordered_map<Uint64, std::vector<int>>> buckets(bands);
+		const auto bandKey = [bands](Uint64 hash, int band) {
+			const int first_bit = band * kHashBits / bands;
+			const int last_bit = (band + 1) * kHashBits / bands;
+			const Uint64 mask = last_bit - first_bit == kHashBits ? ~Uint64(0) : ((Uint64(1) << (last_bit - first_bit)) - 1);
+			return (hash >> first_bit) & mask;
+		};
+		for (size_t i = 0; i < representatives.size(); ++i) {
+			for (int band = 0; band < bands; ++band) {
+				buckets[band][bandKey(hashes[representatives[i]], band)].push_back(representatives[i]);
+			}
+		}
+
+		std::vector<std::vector<int>> matches(representatives.size());
+		parallelFor((int)representatives.size(), [&](int index) {
+			const int tile = representatives[index];
+			for (int band = 0; band < bands; ++band) {
+				const std::vector<int>& bucket = buckets[band].find(bandKey(hashes[tile], band))->second;
+				for (size_t i = 0; i < bucket.size(); ++i) {
+					const int other = bucket[i];
+					if (other > tile && hashDistance(hashes[tile], hashes[other]) <= max_distance && similarAverages(averages[tile], averages[other])) {
+						matches[index].push_back(other);
+					}
+				}
+			}
+		});
+		for (size_t i = 0; i < representatives.size(); ++i) {
+			const int tile = representatives[i];
+			if (parents[tile] != tile)
+				continue;
+			for (size_t j = 0; j < matches[i].size(); ++j) {
+				if (parents[matches[i][j]] == matches[i][j]) {
+					parents[matches[i][j]] = tile;
+				}
+			}
+		}
+	}
+
+	std::unordered_map<int, size_t> group_indices;
+	for (int tile = 0; tile < tile_count_; ++tile) {
+		const int root = findRoot(parents, tile);
+		if (root == tile)
+			continue;
+
+		std::unordered_map<int, size_t>::iterator group_index = group_indices.find(root);
+		if (group_index == group_indices.end()) {
+			group_index = group_indices.emplace(root, groups_.size()).first;
+			groups_.push_back(Group());
+			groups_.back().tiles.push_back(root);
+			groups_.back().exact = true;
+		}
+		Group& group = groups_[group_index->second];
+		group.tiles.push_back(tile);
+		group.exact = group.exact && exact_firsts[tile] == root;
+	}
+}
+
+std::vector<int> TileDuplicates::remapping(const std::vector<size_t>& group_indices) const {
+	std::vector<int> tiles(tile_count_);
+	for (int tile = 0; tile < tile_count_; ++tile) {
+		tiles[tile] = tile;
+	}
+	for (size_t i = 0; i < group_indices.size(); ++i) {
+		const Group& group = groups_[group_indices[i]];
+		for (size_t j = 1; j < group.tiles.size(); ++j) {
+			tiles[group.tiles[j]] = group.tiles[0];
+		}
+	}
+	return tiles;
+}
+
+void TileDuplicates::removeGroups(const std::vector<size_t>& group_indices) {
+	std::vector<bool> removed(groups_.size(), false);
+	for (size_t i = 0; i < group_indices.size(); ++i) {
+		removed[group_indices[i]] = true;
+	}
+	std::vector<Group> groups;
+	for (size_t i = 0; i < groups_.size(); ++i) {
+		if (!removed[i]) {
+			groups.push_back(Group());
+			groups.back().tiles.swap(groups_[i].tiles);
+			groups.back().exact = groups_[i].exact;
+		}
+	}
+	groups_.swap(groups);
+}
+
+Uint64 TileDuplicates::perceptualHash(const Uint32* pixels, int tile_size) {
+	int samples[kHashRows][kHashColumns];
+	for (int row = 0; row < kHashRows; ++row) {
+		const int top = row * tile_size / kHashRows;
+		const int bottom = std::max(top + 1, (row + 1) * tile_size / kHashRows);
+		for (int column = 0; column < kHashColumns; ++column) {
+			const int left = column * tile_size / kHashColumns;
+			const int right = std::max(left + 1, (column + 1) * tile_size / kHashColumns);
+			int sum = 0;
+			for (int y = top; y < bottom; ++y) {
+				for (int x = left; x < right; ++x) {
+					sum += luminance(pixels[size_t(y) * tile_size + x]) / 1000;
+				}
+			}
+			samples[row][column] = sum / ((bottom - top) * (right - left));
+		}
+	}
+
+	Uint64 hash = 0;
+	for (int row = 0; row < kHashRows; ++row) {
+		for (int column = 0; column < kHashColumns - 1; ++column) {
+			hash = (hash << 1) | Uint64(samples[row][column] < samples[row][column + 1]);
+		}
+	}
+	return hash;
+}
\ No newline at end of file
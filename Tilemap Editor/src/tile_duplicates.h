@@ -0,0 +1,28 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+struct ChunkedSurface;
+
+struct TileDuplicates {
+	static constexpr int kMaxDistance = 15;
+
+	struct Group {
+		std::vector<int> tiles;
+		bool exact;
+	};
+
+	TileDuplicates(const ChunkedSurface& sheet, int tile_size, int max_distance);
+
+	std::vector<int> remapping(const std::vector<size_t>& group_indices) const;
+	void removeGroups(const std::vector<size_t>& group_indices);
+
+	const std::vector<Group>& get_groups() const { return groups_; }
+	int get_tile_count() const { return tile_count_; }
+private:
+	static Uint64 perceptualHash(const Uint32* pixels, int tile_size);
+
+	int tile_count_;
+	std::vector<Group> groups_;
+};
\ No newline at end of file
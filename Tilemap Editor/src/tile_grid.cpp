@@ -0,0 +1,229 @@
+#include "tile_grid.h"
+
+#include <algorithm>
+
+#include "mapped_file.h"
+
+TileGrid::TileGrid() :
+	cells_(std::make_shared<std::vector<Uint8>>()),
+	view_(nullptr),
+	columns_(0), rows_(0),
+	stride_(0), capacity_rows_(0),
+	index_width_(1) {
+}
+
+TileGrid::TileGrid(int columns, int rows, int value) :
+	cells_(std::make_shared<std::vector<Uint8>>()),
+	view_(nullptr),
+	columns_(0), rows_(0),
+	stride_(0), capacity_rows_(0),
+	index_width_(indexWidth(value)) {
+	resize(columns, rows, value);
+}
+
+TileGrid::TileGrid(std::shared_ptr<const MappedFile> mapped_file, size_t offset, int columns, int rows, int index_width) :
+	cells_(std::make_shared<std::vector<Uint8>>()),
+	mapped_file_(mapped_file),
+	view_(mapped_file->get_data() + offset),
+	columns_(columns), rows_(rows),
+	stride_(columns), capacity_rows_(rows),
+	index_width_(index_width) {
+}
+
+TileGrid::TileGrid(const TileGrid& other) :
+	cells_(other.cells_),
+	mapped_file_(other.mapped_file_),
+	view_(other.view_),
+	columns_(other.columns_), rows_(other.rows_),
+	stride_(other.stride_), capacity_rows_(other.capacity_rows_),
+	index_width_(other.index_width_) {
+}
+
+TileGrid& TileGrid::operator=(TileGrid other) {
+	swap(other);
+	return *this;
+}
+
+void TileGrid::swap(TileGrid& other) {
+	cells_.swap(other.cells_);
+	mapped_file_.swap(other.mapped_file_);
+	std::swap(view_, other.view_);
+	std::swap(columns_, other.columns_);
+	std::swap(rows_, other.rows_);
+	std::swap(stride_, other.stride_);
+	std::swap(capacity_rows_, other.capacity_rows_);
+	std::swap(index_width_, other.index_width_);
+}
+
+void TileGrid::detach() {
+	if (!mapped_file_ && cells_.use_count() == 1)
+		return;
+
+	cells_ = std::make_shared<std::vector<Uint8>>(view_, view_ + size_t(stride_) * capacity_rows_ * index_width_);
+	view_ = cells_->data();
+	mapped_file_.reset();
+}
+
+void TileGrid::resize(int columns, int rows, int value) {
+	if (columns > columns_) {
+		insertColumns(columns_, columns - columns_, value);
+	} else if (columns < columns_) {
+		removeColumns(columns, columns_ - columns);
+	}
+	if (rows > rows_) {
+		insertRows(rows_, rows - rows_, value);
+	} else if (rows < rows_) {
+		removeRows(rows, rows_ - rows);
+	}
+}
+
+void TileGrid::compact() {
+	detach();
+	reserve(columns_, rows_);
+}
+
+void TileGrid::reserveIndexRange(int index_count) {
+	const int index_width = indexWidth(std::max(index_count - 1, 0));
+	if (index_width > index_width_) {
+		detach();
+		widen(index_width);
+	}
+}
+
+void TileGrid::insertColumns(int position, int count, int value) {
+	if (count <= 0)
+		return;
+
+	detach();
+
+	if (indexWidth(value) > index_width_) {
+		widen(indexWidth(value));
+	}
+	const int columns = columns_ + count;
+	if (columns > stride_) {
+		reserve(std::max(columns, stride_ * 2), capacity_rows_);
+	}
+
+	for (int row = 0; row < rows_; ++row) {
+		Uint8* cells = cells_->data() + size_t(row) * stride_ * index_width_;
+		std::copy_backward(cells + position * index_width_, cells + columns_ * index_width_, cells + columns * index_width_);
+		fillCells(cells + position * index_width_, count, value);
+	}
+	columns_ = columns;
+}
+
+void TileGrid::insertRows(int position, int count, int value) {
+	if (count <= 0)
+		return;
+
+	detach();
+
+	if (indexWidth(value) > index_width_) {
+		widen(indexWidth(value));
+	}
+	const int rows = rows_ + count;
+	if (rows > capacity_rows_) {
+		reserve(stride_, std::max(rows, capacity_rows_ * 2));
+	}
+
+	const size_t row_bytes = size_t(stride_) * index_width_;
+	Uint8* cells = cells_->data();
+	std::copy_backward(cells + position * row_bytes, cells + rows_ * row_bytes, cells + rows * row_bytes);
+	for (int row = position; row < position + count; ++row) {
+		fillCells(cells + row * row_bytes, columns_, value);
+	}
+	rows_ = rows;
+}
+
+void TileGrid::removeColumns(int position, int count) {
+	count = std::min(count, columns_ - position);
+	if (count <= 0)
+		return;
+
+	detach();
+
+	for (int row = 0; row < rows_; ++row) {
+		Uint8* cells = cells_->data() + size_t(row) * stride_ * index_width_;
+		std::copy(cells + (position + count) * index_width_, cells + columns_ * index_width_, cells + position * index_width_);
+	}
+	columns_ -= count;
+	maybeCompact();
+}
+
+void TileGrid::removeRows(int position, int count) {
+	count = std::min(count, rows_ - position);
+	if (count <= 0)
+		return;
+
+	detach();
+
+	const size_t row_bytes = size_t(stride_) * index_width_;
+	Uint8* cells = cells_->data();
+	std::copy(cells + (position + count) * row_bytes, cells + rows_ * row_bytes, cells + position * row_bytes);
+	rows_ -= count;
+	maybeCompact();
+}
+
+int TileGrid::indexWidth(int value) {
+	if (Uint32(value) <= 0xff)
+		return 1;
+	if (Uint32(value) <= 0xffff)
+		return 2;
+	return 4;
+}
+
+void TileGrid::widen(int index_width) {
+	std::vector<Uint8> cells(size_t(stride_) * capacity_rows_ * index_width);
+	const int previous_index_width = index_width_;
+	index_width_ = index_width;
+	for (int row = 0; row < rows_; ++row) {
+		for (int column = 0; column < columns_; ++column) {
+			const size_t index = size_t(row) * stride_ + column;
+			int value;
+			switch (previous_index_width) {
+			case 1: value = (*cells_)[index]; break;
+			case 2: value = ((const Uint16*)cells_->data())[index]; break;
+			default: value = ((const Uint32*)cells_->data())[index]; break;
+			}
+			fillCells(cells.data() + index * index_width, 1, value);
+		}
+	}
+	cells_->swap(cells);
+	view_ = cells_->data();
+}
+
+void TileGrid::reserve(int stride, int capacity_rows) {
+	if (stride == stride_ && capacity_rows == capacity_rows_)
+		return;
+
+	if (stride == stride_) {
+		cells_->resize(size_t(stride) * capacity_rows * index_width_);
+		if (capacity_rows < capacity_rows_) {
+			cells_->shrink_to_fit();
+		}
+	} else {
+		std::vector<Uint8> cells(size_t(stride) * capacity_rows * index_width_);
+		for (int row = 0; row < rows_; ++row) {
+			std::vector<Uint8>::const_iterator source = cells_->begin() + size_t(row) * stride_ * index_width_;
+			std::copy(source, source + columns_ * index_width_, cells.begin() + size_t(row) * stride * index_width_);
+		}
+		cells_->swap(cells);
+	}
+	view_ = cells_->data();
+	stride_ = stride;
+	capacity_rows_ = capacity_rows;
+}
+
+void TileGrid::maybeCompact() {
+	if (size_t(stride_) * capacity_rows_ > size_t(kCompactionSlack) * std::max(columns_ * rows_, 1)) {
+		compact();
+	}
+}
+
+void TileGrid::fillCells(Uint8* cells, int count, int value) const {
+	switch (index_width_) {
+	case 1: std::fill(cells, cells + count, Uint8(value)); break;
+	case 2: std::fill((Uint16*)cells, (Uint16*)cells + count, Uint16(value)); break;
+	default: std::fill((Uint32*)cells, (Uint32*)cells + count, Uint32(value)); break;
+	}
+}
\ No newline at end of file
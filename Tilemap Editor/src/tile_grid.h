@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+struct MappedFile;
+
+struct TileGrid {
+	static constexpr int kCompactionSlack = 4;
+
+	TileGrid();
+	TileGrid(int columns, int rows, int value);
+	TileGrid(std::shared_ptr<const MappedFile> mapped_file, size_t offset, int columns, int rows, int index_width);
+	TileGrid(const TileGrid& other);
+	TileGrid& operator=(TileGrid other);
+
+	void swap(TileGrid& other);
+	void detach();
+
+	void resize(int columns, int rows, int value);
+	void compact();
+	void reserveIndexRange(int index_count);
+
+	void insertColumns(int position, int count, int value);
+	void insertRows(int position, int count, int value);
+	void removeColumns(int position, int count);
+	void removeRows(int position, int count);
+
+	int get(int column, int row) const {
+		const size_t index = size_t(row) * stride_ + column;
+		switch (index_width_) {
+		case 1: return view_[index];
+		case 2: return ((const Uint16*)view_)[index];
+		default: return ((const Uint32*)view_)[index];
+		}
+	}
+	void set(int column, int row, int value) {
+		if (mapped_file_ || cells_.use_count() > 1) {
+			detach();
+		}
+		if (indexWidth(value) > index_width_) {
+			widen(indexWidth(value));
+		}
+		fillCells(cells_->data() + (size_t(row) * stride_ + column) * index_width_, 1, value);
+	}
+
+	const Uint8* get_row(int row) const { return view_ + size_t(row) * stride_ * index_width_; }
+	bool isMapped() const { return mapped_file_ != nullptr; }
+	bool empty() const { return columns_ == 0 || rows_ == 0; }
+	int get_columns() const { return columns_; }
+	int get_rows() const { return rows_; }
+	int get_stride() const { return stride_; }
+	int get_capacity_rows() const { return capacity_rows_; }
+	int get_index_width() const { return index_width_; }
+private:
+	static int indexWidth(int value);
+	void widen(int index_width);
+	void reserve(int stride, int capacity_rows);
+	void maybeCompact();
+	void fillCells(Uint8* cells, int count, int value) const;
+
+	std::shared_ptr<std::vector<Uint8>> cells_;
+	std::shared_ptr<const MappedFile> mapped_file_;
+	const Uint8* view_;
+	int columns_, rows_;
+	int stride_, capacity_rows_;
+	int index_width_;
+};
\ No newline at end of file
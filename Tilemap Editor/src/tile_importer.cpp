@@ -0,0 +1,56 @@
+#include "tile_importer.h"
+
+#include <cmath>
+
+#include "chunked_surface.h"
+#include "parallel.h"
+#include "tile_table.h"
+
+TileImporter::TileImporter(const ChunkedSurface& image, int tile_size) :
+	tile_size_(tile_size),
+	image_columns_(0),
+	sheet_columns_(0), sheet_rows_(0) {
+	TileTable tile_table(image, tile_size);
+	const int columns = tile_table.get_columns();
+	const int rows = tile_table.get_rows();
+	image_columns_ = columns;
+
+	std::vector<Uint32> entries(size_t(columns) * rows);
+	parallelFor(rows, [&](int row) {
+		std::vector<Uint32> tile_pixels(size_t(tile_size) * tile_size);
+		for (int column = 0; column < columns; ++column) {
+			const int tile = row * columns + column;
+			const Uint64 hash = tile_table.readTile(tile, tile_pixels.data());
+			entries[tile] = tile_table.insert(tile, hash, tile_pixels.data());
+		}
+	});
+
+	tile_grid_ = TileGrid(columns, rows, 0);
+	std::vector<int> sheet_indices(entries.size());
+	for (int tile = 0; tile < (int)entries.size(); ++tile) {
+		const int first = tile_table.get_first(entries[tile]);
+		if (first == tile) {
+			sheet_indices[tile] = (int)sheet_tiles_.size();
+			sheet_tiles_.push_back(tile);
+		} else {
+			sheet_indices[tile] = sheet_indices[first];
+		}
+		tile_grid_.set(tile % columns, tile / columns, sheet_indices[tile]);
+	}
+
+	if (!sheet_tiles_.empty()) {
+		sheet_columns_ = (int)std::ceil(std::sqrt(double(sheet_tiles_.size())));
+		sheet_rows_ = ((int)sheet_tiles_.size() + sheet_columns_ - 1) / sheet_columns_;
+	}
+}
+
+SDL_Rect TileImporter::get_source_rectangle(int sheet_tile) const {
+	const int tile = sheet_tiles_[sheet_tile];
+	const SDL_Rect rectangle = { (tile % image_columns_) * tile_size_, (tile / image_columns_) * tile_size_, tile_size_, tile_size_ };
+	return rectangle;
+}
+
+SDL_Point TileImporter::get_sheet_position(int sheet_tile) const {
+	const SDL_Point position = { (sheet_tile % sheet_columns_) * tile_size_, (sheet_tile / sheet_columns_) * tile_size_ };
+	return position;
+}
\ No newline at end of file
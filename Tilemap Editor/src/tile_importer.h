@@ -0,0 +1,26 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+#include "tile_grid.h"
+
+struct ChunkedSurface;
+
+struct TileImporter {
+	TileImporter(const ChunkedSurface& image, int tile_size);
+
+	SDL_Rect get_source_rectangle(int sheet_tile) const;
+	SDL_Point get_sheet_position(int sheet_tile) const;
+
+	const TileGrid& get_tile_grid() const { return tile_grid_; }
+	int get_sheet_tile_count() const { return (int)sheet_tiles_.size(); }
+	int get_sheet_width() const { return sheet_columns_ * tile_size_; }
+	int get_sheet_height() const { return sheet_rows_ * tile_size_; }
+private:
+	int tile_size_;
+	int image_columns_;
+	int sheet_columns_, sheet_rows_;
+	std::vector<int> sheet_tiles_;
+	TileGrid tile_grid_;
+};
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "tile_map_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "canvas.h"
+#include "surface_window.h"
+#include "tile_grid.h"
+
+namespace {
+	Uint32 average(Uint32 a, Uint32 b) {
+		return (a & b) + (((a ^ b) & 0xfefefefe) >> 1);
+	}
+
+	int bandForScale(float scale) {
+		if (scale >= 1.0f)
+			return 0;
+		return std::min(int(round(log2(1.0f / scale))), TileChunkCache::kMaxBand);
+	}
+}
+
+TileMapRenderer::TileMapRenderer(std::shared_ptr<PixelPool> pixel_pool, size_t cache_budget_bytes) :
+	cache_(pixel_pool, cache_budget_bytes),
+	tiles_per_chunk_(tilesPerChunk(1)) {
+}
+
+void TileMapRenderer::draw(SurfaceWindow& graphics, const Canvas& canvas, const Canvas& atlas, const TileGrid& tile_grid, int tile_size) {
+	SDL_Rect visible_rectangle;
+	if (tile_size <= 0 || tile_grid.empty() || !canvas.visibleWorldRectangle(graphics.get_clip_rectangle(), visible_rectangle))
+		return;
+
+	const float scale_x = canvas.get_scale_x();
+	const float scale_y = canvas.get_scale_y();
+	const bool integer_scale = scale_x >= 1 && scale_y >= 1 && scale_x == floor(scale_x) && scale_y == floor(scale_y);
+	const int band = bandForScale(std::min(scale_x, scale_y));
+
+	if (tilesPerChunk(tile_size) != tiles_per_chunk_) {
+		tiles_per_chunk_ = tilesPerChunk(tile_size);
+		cache_.clear();
+	}
+	const int chunk_size = tiles_per_chunk_ * tile_size;
+	const int columns = (tile_grid.get_columns() + tiles_per_chunk_ - 1) / tiles_per_chunk_;
+	const int rows = (tile_grid.get_rows() + tiles_per_chunk_ - 1) / tiles_per_chunk_;
+
+	const int first_column = visible_rectangle.x / chunk_size;
+	const int last_column = std::min((visible_rectangle.x + visible_rectangle.w - 1) / chunk_size, columns - 1);
+	const int first_row = visible_rectangle.y / chunk_size;
+	const int last_row = std::min((visible_rectangle.y + visible_rectangle.h - 1) / chunk_size, rows - 1);
+	for (int row = first_row; row <= last_row; ++row) {
+		for (int column = first_column; column <= last_column; ++column) {
+			SDL_Surface* chunk = cache_.find(band, column, row);
+			if (!chunk) {
+				chunk = renderChunk(atlas, tile_grid, tile_size, band, column, row);
+			}
+
+			const int chunk_left = column * chunk_size;
+			const int chunk_top = row * chunk_size;
+			const int chunk_width = std::min(chunk_size, tile_grid.get_columns() * tile_size - chunk_left);
+			const int chunk_height = std::min(chunk_size, tile_grid.get_rows() * tile_size - chunk_top);
+			const int world_left = std::max(visible_rectangle.x, chunk_left) - chunk_left;
+			const int world_top = std::max(visible_rectangle.y, chunk_top) - chunk_top;
+			const int world_right = std::min(visible_rectangle.x + visible_rectangle.w, chunk_left + chunk_size) - chunk_left;
+			const int world_bottom = std::min(visible_rectangle.y + visible_rectangle.h, chunk_top + chunk_size) - chunk_top;
+
+			SDL_Rect source_rectangle;
+			source_rectangle.x = world_left >> band;
+			source_rectangle.y = world_top >> band;
+			source_rectangle.w = std::min((world_right + (1 << band) - 1) >> band, chunk->w) - source_rectangle.x;
+			source_rectangle.h = std::min((world_bottom + (1 << band) - 1) >> band, chunk->h) - source_rectangle.y;
+
+			int screen_left, screen_top;
+			canvas.worldToScreen(float(chunk_left + (source_rectangle.x << band)), float(chunk_top + (source_rectangle.y << band)), screen_left, screen_top);
+			int screen_right, screen_bottom;
+			canvas.worldToScreen(float(chunk_left + std::min((source_rectangle.x + source_rectangle.w) << band, chunk_width)),
+				float(chunk_top + std::min((source_rectangle.y + source_rectangle.h) << band, chunk_height)), screen_right, screen_bottom);
+			SDL_Rect destination_rectangle = { screen_left, screen_top, screen_right - screen_left, screen_bottom - screen_top };
+
+			if (band == 0 && integer_scale) {
+				graphics.blitSurfaceInteger(chunk, source_rectangle, screen_left, screen_top, int(scale_x), int(scale_y));
+			} else {
+				graphics.blitSurface(chunk, &source_rectangle, &destination_rectangle, false);
+			}
+		}
+	}
+}
+
+void TileMapRenderer::invalidateTile(int column, int row) {
+	cache_.invalidate(column / tiles_per_chunk_, row / tiles_per_chunk_);
+}
+
+void TileMapRenderer::invalidate() {
+	cache_.clear();
+}
+
+int TileMapRenderer::tilesPerChunk(int tile_size) {
+	return std::max(1, kChunkPixels / tile_size);
+}
+
+SDL_Surface* TileMapRenderer::renderChunk(const Canvas& atlas, const TileGrid& tile_grid, int tile_size, int band, int column, int row) {
+	const int first_row = row * tiles_per_chunk_;
+	const int first_column = column * tiles_per_chunk_;
+	const int rows = std::min(tiles_per_chunk_, tile_grid.get_rows() - first_row);
+	const int columns = std::min(tiles_per_chunk_, tile_grid.get_columns() - first_column);
+
+	int width = columns * tile_size;
+	int height = rows * tile_size;
+	scratch_.resize(width * height);
+	for (int tile_row = 0; tile_row < rows; ++tile_row) {
+		for (int tile_column = 0; tile_column < columns; ++tile_column) {
+			const int tile_index = tile_grid.get(first_column + tile_column, first_row + tile_row);
+			copyTile(atlas.get_surface(), tile_index, tile_size, scratch_.data() + tile_row * tile_size * width + tile_column * tile_size, width);
+		}
+	}
+
+	const int pitch = width;
+	for (int level = 0; level < band; ++level) {
+		const int level_width = (width + 1) / 2;
+		const int level_height = (height + 1) / 2;
+		for (int y = 0; y < level_height; ++y) {
+			const Uint32* top_row = scratch_.data() + std::min(y * 2, height - 1) * pitch;
+			const Uint32* bottom_row = scratch_.data() + std::min(y * 2 + 1, height - 1) * pitch;
+			Uint32* destination = scratch_.data() + y * pitch;
+			for (int x = 0; x < level_width; ++x) {
+				const int left = std::min(x * 2, width - 1);
+				const int right = std::min(x * 2 + 1, width - 1);
+				destination[x] = average(average(top_row[left], top_row[right]), average(bottom_row[left], bottom_row[right]));
+			}
+		}
+		width = level_width;
+		height = level_height;
+	}
+
+	SDL_Surface* chunk = cache_.insert(band, column, row, width, height);
+	for (int y = 0; y < height; ++y) {
+		memcpy((Uint8*)chunk->pixels_ + y * chunk->pitch, scratch_.data() + y * pitch, width * sizeof(Uint32));
+	}
+	return chunk;
+}
+
+void TileMapRenderer::copyTile(const ChunkedSurface& atlas, int tile_index, int tile_size, Uint32* destination, int pitch) {
+	const int atlas_columns = atlas.get_width() / tile_size;
+	const int atlas_rows = atlas.get_height() / tile_size;
+	if (tile_index < 0 || tile_index >= atlas_columns * atlas_rows) {
+		for (int y = 0; y < tile_size; ++y) {
+			std::fill(destination + y * pitch, destination + y * pitch + tile_size, atlas.get_fill_pixel());
+		}
+		return;
+	}
+
+	const int source_x = (tile_index % atlas_columns) * tile_size;
+	const int source_y = (tile_index / atlas_columns) * tile_size;
+	for (int y = 0; y < tile_size; ++y) {
+		Uint32* destination_row = destination + y * pitch;
+		for (int x = 0; x < tile_size;) {
+			int length;
+			const Uint32* source = atlas.pixelSpan(source_x + x, source_y + y, length);
+			length = std::min(length, tile_size - x);
+			memcpy(destination_row + x, source, length * sizeof(Uint32));
+			x += length;
+		}
+	}
+}
\ No newline at end of file
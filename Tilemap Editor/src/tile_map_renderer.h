@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+#include <vector>
+
+#include "tile_chunk_cache.h"
+
+struct SurfaceWindow;
+struct Canvas;
+struct ChunkedSurface;
+struct PixelPool;
+struct TileGrid;
+
+struct TileMapRenderer {
+	static constexpr int kChunkPixels = 256;
+
+	TileMapRenderer(std::shared_ptr<PixelPool> pixel_pool, size_t cache_budget_bytes);
+
+	void draw(SurfaceWindow& graphics, const Canvas& canvas, const Canvas& atlas, const TileGrid& tile_grid, int tile_size);
+
+	void invalidateTile(int column, int row);
+	void invalidate();
+
+	static int tilesPerChunk(int tile_size);
+	static void copyTile(const ChunkedSurface& atlas, int tile_index, int tile_size, Uint32* destination, int pitch);
+
+	TileChunkCache& get_cache() { return cache_; }
+	const TileChunkCache& get_cache() const { return cache_; }
+private:
+	SDL_Surface* renderChunk(const Canvas& atlas, const TileGrid& tile_grid, int tile_size, int band, int column, int row);
+
+	TileChunkCache cache_;
+	std::vector<Uint32> scratch_;
+	int tiles_per_chunk_;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "tile_table.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "chunked_surface.h"
+
+namespace {
+	const Uint64 kHashMultiplier = 0x9e3779b97f4a7c15ull;
+}
+
+TileTable::TileTable(const ChunkedSurface& pixels, int tile_size) :
+	pixels_(pixels),
+	tile_size_(tile_size),
+	columns_((pixels.get_width() + tile_size - 1) / tile_size),
+	rows_((pixels.get_height() + tile_size - 1) / tile_size) {
+}
+
+Uint64 TileTable::readTile(int tile, Uint32* destination) const {
+	const int x = (tile % columns_) * tile_size_;
+	const int y = (tile / columns_) * tile_size_;
+	const int width = std::min(tile_size_, pixels_.get_width() - x);
+	const int height = std::min(tile_size_, pixels_.get_height() - y);
+	for (int row = 0; row < tile_size_; ++row) {
+		Uint32* destination_row = destination + size_t(row) * tile_size_;
+		if (row < height) {
+			pixels_.readRow(x, y + row, width, destination_row);
+			std::fill(destination_row + width, destination_row + tile_size_, pixels_.get_fill_pixel());
+		} else {
+			std::fill(destination_row, destination_row + tile_size_, pixels_.get_fill_pixel());
+		}
+	}
+
+	Uint64 hash = 0;
+	for (int i = 0; i < tile_size_ * tile_size_; ++i) {
+		hash = (hash ^ destination[i]) * kHashMultiplier;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+Uint32 TileTable::insert(int tile, Uint64 hash, const Uint32* tile_pixels) {
+	const Uint32 shard_index = Uint32(hash >> (64 - kShardBits));
+	Shard& shard = shards_[shard_index];
+	const size_t tile_area = size_t(tile_size_) * tile_size_;
+
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	const auto candidates = shard.slots.equal_range(hash);
+	for (auto candidate = candidates.first; candidate != candidates.second; ++candidate) {
+		if (memcmp(shard.pixels.data() + candidate->second * tile_area, tile_pixels, tile_area * sizeof(Uint32)) == 0) {
+			int& first = shard.firsts[candidate->second];
+			first = std::min(first, tile);
+			return (candidate->second << kShardBits) | shard_index;
+		}
+	}
+
+	const Uint32 slot = Uint32(shard.firsts.size());
+	shard.firsts.push_back(tile);
+	shard.pixels.insert(shard.pixels.end(), tile_pixels, tile_pixels + tile_area);
+	shard.slots.emplace(hash, slot);
+	return (slot << kShardBits) | shard_index;
+}
+
+int TileTable::get_first(Uint32 entry) const {
+	return shards_[entry & (kShardCount - 1)].firsts[entry >> kShardBits];
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <SDL.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct ChunkedSurface;
+
+struct TileTable {
+	static constexpr int kShardBits = 6;
+	static constexpr int kShardCount = 1 << kShardBits;
+
+	TileTable(const ChunkedSurface& pixels, int tile_size);
+
+	TileTable(const TileTable&) = delete;
+	TileTable& operator=(const TileTable&) = delete;
+
+	Uint64 readTile(int tile, Uint32* destination) const;
+	Uint32 insert(int tile, Uint64 hash, const Uint32* tile_pixels);
+	int get_first(Uint32 entry) const;
+
+	int get_tile_size() const { return tile_size_; }
+	int get_columns() const { return columns_; }
+	int get_rows() const { return rows_; }
+	int get_tile_count() const { return columns_ * rows_; }
+private:
+	struct Shard {
+		std::mutex mutex;
+		std::unordered_multimap<Uint64, Uint32> slots;
+		std::vector<int> firsts;
+		std::vector<Uint32> pixels;
+	};
+
+	const ChunkedSurface& pixels_;
+	int tile_size_;
+	int columns_, rows_;
+	Shard shards_[kShardCount];
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "tile_trimmer.h"
+
+#include <cmath>
+
+#include "chunked_surface.h"
+#include "parallel.h"
+
+TileTrimmer::TileTrimmer(const std::vector<TileGrid>& tile_grids, int tile_count) :
+	atlas_indices_(tile_count, -1),
+	atlas_columns_(0), atlas_rows_(0) {
+	std::vector<std::vector<Uint8>> used(tile_grids.size());
+	parallelFor((int)tile_grids.size(), [&](int index) {
+		const TileGrid& tile_grid = tile_grids[index];
+		used[index].assign(tile_count, 0);
+		for (int row = 0; row < tile_grid.get_rows(); ++row) {
+			for (int column = 0; column < tile_grid.get_columns(); ++column) {
+				const int tile_index = tile_grid.get(column, row);
+				if (tile_index >= 0 && tile_index < tile_count) {
+					used[index][tile_index] = 1;
+				}
+			}
+		}
+	});
+
+	for (int tile = 0; tile < tile_count; ++tile) {
+		for (size_t i = 0; i < used.size(); ++i) {
+			if (used[i][tile]) {
+				atlas_indices_[tile] = (int)used_tiles_.size();
+				used_tiles_.push_back(tile);
+				break;
+			}
+		}
+	}
+
+	if (!used_tiles_.empty()) {
+		atlas_columns_ = (int)std::ceil(std::sqrt(double(used_tiles_.size())));
+		atlas_rows_ = ((int)used_tiles_.size() + atlas_columns_ - 1) / atlas_columns_;
+	}
+}
+
+TileGrid TileTrimmer::remap(const TileGrid& tile_grid) const {
+	const int invalid_index = atlas_columns_ * atlas_rows_;
+	TileGrid trimmed_grid(tile_grid.get_columns(), tile_grid.get_rows(), invalid_index);
+	for (int row = 0; row < tile_grid.get_rows(); ++row) {
+		for (int column = 0; column < tile_grid.get_columns(); ++column) {
+			const int tile_index = tile_grid.get(column, row);
+			if (tile_index >= 0 && tile_index < (int)atlas_indices_.size()) {
+				trimmed_grid.set(column, row, atlas_indices_[tile_index]);
+			}
+		}
+	}
+	return trimmed_grid;
+}
+
+void TileTrimmer::copyAtlas(const ChunkedSurface& sheet, int tile_size, ChunkedSurface& atlas) const {
+	const int sheet_columns = sheet.get_width() / tile_size;
+	for (int i = 0; i < (int)used_tiles_.size(); ++i) {
+		const SDL_Rect source_rectangle = { (used_tiles_[i] % sheet_columns) * tile_size, (used_tiles_[i] / sheet_columns) * tile_size, tile_size, tile_size };
+		atlas.copyRegion(sheet, source_rectangle, (i % atlas_columns_) * tile_size, (i / atlas_columns_) * tile_size);
+	}
+}
\ No newline at end of file
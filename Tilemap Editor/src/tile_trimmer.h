@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SDL.h>
+#include <vector>
+
+#include "tile_grid.h"
+
+struct ChunkedSurface;
+
+struct TileTrimmer {
+	TileTrimmer(const std::vector<TileGrid>& tile_grids, int tile_count);
+
+	TileGrid remap(const TileGrid& tile_grid) const;
+	void copyAtlas(const ChunkedSurface& sheet, int tile_size, ChunkedSurface& atlas) const;
+
+	int get_atlas_width(int tile_size) const { return atlas_columns_ * tile_size; }
+	int get_atlas_height(int tile_size) const { return atlas_rows_ * tile_size; }
+	int get_used_tile_count() const { return (int)used_tiles_.size(); }
+private:
+	std::vector<int> atlas_indices_;
+	std::vector<int> used_tiles_;
+	int atlas_columns_, atlas_rows_;
+};
\ No newline at end of file